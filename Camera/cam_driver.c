@@ -1,774 +1,1496 @@
-/******************************************************************************
-* CAM_DRIVER.C
-* 
-* Implementation of the camera driver for OLED display. This file contains
-* the core functionality for controlling an SSD1351-based OLED display with
-* real-time camera input or pre-recorded YUV420 video playback.
-* 
-* The implementation provides thread-based handling of video streams, colorspace
-* conversion from YUV420 to RGB565 for display, and proper resource management
-* for the OLED hardware. It supports both file-based playback and real-time
-* streaming through a named pipe.
-*
-* Key features:
-*   - 30 FPS video playback with timing control
-*   - YUV420 to RGB565 colorspace conversion
-*   - Threaded handling of display operations
-*   - Named pipe support for real-time camera feed
-*   - SPI interface to 128x128 OLED display
-*
-* Hardware requirements:
-*   - Waveshare 1.5" RGB OLED display (SSD1327 controller)
-*   - GPIO pins for controlling OLED (DC, RST, CS)
-*   - SPI interface for data transfer
-*
-* Dependencies:
-*   - lgpio.h - for GPIO control
-*   - OLED_1in5_rgb.h - Waveshare OLED driver
-*   - pthread.h - POSIX threads
-*   - linux/spi/spidev.h - Linux SPI interface
-* 
-* Author: The One Project is Real!!!!
-* Date: 02/19/2025
-* License: Version 2.1, February 1999
-*
-* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
-* <https://fsf.org/>
-* Everyone is permitted to copy and distribute verbatim copies
-* of this license document, but changing it is not allowed.
-*
-* [This is the first released version of the Lesser GPL.  It also counts
-*  as the successor of the GNU Library Public License, version 2, hence
-*  the version number 2.1.]
-*
- ******************************************************************************/
- #include "cam_driver.h"         // driver header file
- #include <stdio.h>
- #include <stdlib.h>
- #include <string.h>
- #include <unistd.h>
- #include <fcntl.h>              // for file control
- #include <errno.h>
- #include <sys/stat.h>       
- #include <signal.h>
- #include <time.h>
- #include <pthread.h>
- #include <sys/ioctl.h>	        // device-specific I/O operations
- #include <sys/types.h>
- #include <linux/spi/spidev.h>   // for SPI device control; transfer data to SPI peripherals
- #include <lgpio.h>              // GPIO control
- #include "OLED_1in5_rgb.h"      // header file for OLED
- #include "GUI_Paint.h"          // header file for OLED colors
- #include "test.h"
- #include "DEV_Config.h"
- 
- // OLED Constants for Waveshare 1.5" OLED
- #define OLED_WIDTH  DISPLAY_WIDTH
- #define OLED_HEIGHT DISPLAY_HEIGHT
- #define OLED_DC_PIN 22      // Data/Command pin (BCM numbering)
- #define OLED_RST_PIN 13     // Reset pin
- #define OLED_CS_PIN  24     // Chip select pin
- 
- // Control initialization
- static volatile int display_active = 0;
- static volatile int pipe_created = 0;
- static pthread_t display_thread;
- 
- // Static function declarations
- static void* display_thread_func(void* arg);
- static void* pipe_thread_func(void* arg);
- //static void yuv420_to_rgb(uint8_t y, uint8_t u, uint8_t v, uint8_t *r, uint8_t *g, uint8_t *b);
- 
- // Allocate OLED buffer (RGB565 format - 2 bytes per pixel)
- //static UWORD *oled_buffer = NULL;
- static UBYTE *oled_buffers[2] = {0, 0}; // double buffering
- static int current_buffer = 0;
- static UWORD buffer_size = (OLED_WIDTH*2) * OLED_HEIGHT;
- //static UBYTE *oled_buffer = NULL;
- 
- /******************************************************************************
- * function: oled_init
- * brief: Initialize the OLED display
- * 
- * This function sets up the SPI interface and configures the display
- * for proper operation with the Waveshare 1.5" OLED with SSD1352 controller.
- * It initializes the display module, clears the screen, and allocates memory
- * for the display buffer.
- * 
- * returns 0 on success, -1 on failure
- ******************************************************************************/
- int oled_init(void) 
- {
-     printf("Initializing OLED display...\n");
- 
-     // Initialize the device with driver
-     if(DEV_ModuleInit() != 0) 
-     {
-         printf("DEV_ModuleInit failed\n");
-         return -1;
-     }
- 
-     // Initialize the OLED display
-     OLED_1in5_rgb_Init();
-     DEV_Delay_ms(100);
-     
-     // Clear the display to start with a blank screen
-     OLED_1in5_rgb_Clear();
- 
-     // Allocate the display buffer just once at initialization
-     //buffer_size = (OLED_WIDTH*2) * OLED_HEIGHT; // RGB565 format (2 bytes per pixel)
-     //oled_buffer = (UWORD *)malloc(buffer_size);
-     // if (oled_buffer == NULL) 
-     // {
-     //     printf("Failed to allocate display buffer\n");
-     //     return -1;
-     // }
-     if(init_display_buffers() != 0)
-     {
-         printf("Failed to initialize display buffers\n");
-         return -1;
-     }
-     
-     // Initialize buffer to all black
-     //memset(oled_buffer, 0, buffer_size);
- 
-     printf("OLED display initialized\n");
-     return 0;
- }
- 
- //new code for initializing the buffers at the startup of the program
- int init_display_buffers(void)
- {
-     buffer_size = (OLED_WIDTH*2) * OLED_HEIGHT; // RGB565 format (2 bytes per pixel)
- 
-     if(oled_buffers[0] == NULL)
-     {
-         oled_buffers[0] = (UBYTE *)malloc(buffer_size);
-         if(oled_buffers[0] == NULL)
-         {
-             perror("Failed to allocate OLED buffer 0");
-             return -1;
-         }
-         memset(oled_buffers[0], 0, buffer_size); // Initialize to black
-     }
- 
-     if(oled_buffers[1] == NULL)
-     {
-         oled_buffers[1] = (UBYTE *)malloc(buffer_size);
-         if(oled_buffers[1] == NULL)
-         {
-             perror("Failed to allocate OLED buffer 1");
-             free(oled_buffers[0]);
-             oled_buffers[0] = NULL;
-             return -1;
-         }
-         memset(oled_buffers[1], 0, buffer_size);
-     }
- 
-     return 0;
- }
- 
- /******************************************************************************
- * function: yuv420_to_rgb
- * brief: Convert YUV420 color space to RGB
- * 
- * This function implements the standard YUV420 to RGB color conversion formula,
- * with proper clamping of values to ensure valid RGB output in the range [0-255].
- *
- * Parameters:
- *   y - Y component (luminance)
- *   u - U component (chrominance)
- *   v - V component (chrominance)
- *   r - Pointer to store resulting Red component
- *   g - Pointer to store resulting Green component
- *   b - Pointer to store resulting Blue component
- ******************************************************************************/
- void yuv420_to_rgb(uint8_t y, uint8_t u, uint8_t v, uint8_t *r, uint8_t *g, uint8_t *b) 
- {
-     // YUV to RGB conversion formula
-     int c = y - 16;
-     int d = u - 128;
-     int e = v - 128;
-     
-     // Calculate RGB values
-     int r_temp = (298 * c + 409 * e + 128) >> 8;
-     int g_temp = (298 * c - 100 * d - 208 * e + 128) >> 8;
-     int b_temp = (298 * c + 516 * d + 128) >> 8;
- 
-     // Calculate RGB components with lookups and fixed-point math
-     // int r = (y_val + uvTable[v][3] + 128) >> 8;
-     // int g = (y_val + uvTable[u][1] + uvTable[v][4] + 128) >> 8;
-     // int b = (y_val + uvTable[u][2] + 128) >> 8;
-     
-     // Clamp values to valid range [0, 255]
-     *r = (r_temp < 0) ? 0 : ((r_temp > 255) ? 255 : r_temp);
-     *g = (g_temp < 0) ? 0 : ((g_temp > 255) ? 255 : g_temp);
-     *b = (b_temp < 0) ? 0 : ((b_temp > 255) ? 255 : b_temp);
-     // int r = (r < 0) ? 0 : ((r > 255) ? 255 : r);
-     // int g = (g < 0) ? 0 : ((g > 255) ? 255 : g);
-     // int b = (b < 0) ? 0 : ((b > 255) ? 255 : b);
- 
-     // Convert RGB to RGB565 directly
-     //return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
- }
- 
- /******************************************************************************
- * function: start_video_display
- * brief: Start video playback on the OLED display
- * 
- * This function starts a background thread that reads YUV420 frames
- * from the specified file and displays them on the OLED at the
- * appropriate frame rate. The video file is played in a loop.
- * 
- * returns 0 on success, -1 on failure 
- *
- * errors: 
- *   - if display is already active
- *   - file doesn't exist
- *   - thread creation fails
- ******************************************************************************/
- int start_video_display(const char *yuv_filename) 
- {
-     if (display_active) 
-     {
-         fprintf(stderr, "Display is active\n");
-         return -1;
-     }
-     
-     // Check if file exists
-     FILE* test = fopen(yuv_filename, "rb");
-     if (!test) 
-     {
-         perror("Cannot open YUV file");
-         return -1;
-     }
-     fclose(test);
-     
-     // Set flag and create thread
-     display_active = 1;
-     
-     // Create thread for playback
-     if (pthread_create(&display_thread, NULL, display_thread_func, (void*)yuv_filename) != 0) 
-     {
-         perror("Failed to create display thread");
-         display_active = 0;
-         return -1;
-     }
-     
-     return 0;
- }
- 
- /******************************************************************************
- * function: display_thread_func
- * brief: Thread function for file playback
- * 
- * This function runs in a separate thread and handles reading frames from a YUV420
- * video file, converting them to RGB565, and displaying them on the OLED at the
- * specified frame rate. It implements timing control to maintain constant FPS.
- *
- * returns NULL on completion
- ******************************************************************************/
- static void* display_thread_func(void* arg) 
- {
-     const char* filename = (const char*)arg;
-     FILE* file = fopen(filename, "rb");
-     if (!file) 
-     {
-         perror("Failed to open YUV file");
-         display_active = 0;
-         return NULL;
-     }
-     
-     // Allocate frame buffer for YUV data
-     size_t frame_size = OLED_WIDTH * OLED_HEIGHT * 3 / 2; // YUV420 size
-     uint8_t* frame_buffer = malloc(frame_size);
-     if (!frame_buffer) 
-     {
-         perror("Failed to allocate frame buffer");
-         fclose(file);
-         display_active = 0;
-         return NULL;
-     }
- 
-     // Frame timing variables
-     struct timespec frame_time;
-     long frame_duration_ns = 1000000000 / FPS;
-     
-     while (display_active) 
-     {
-         // Get start time for frame rate control
-         clock_gettime(CLOCK_MONOTONIC, &frame_time);
-         
-         // Read a frame from the file
-         size_t bytes_read = fread(frame_buffer, 1, frame_size, file);
-         if (bytes_read < frame_size) 
-         {
-             // End of file or error, rewind to beginning
-             rewind(file);
-             continue;
-         }
-         
-         // using new function to display frame
-         display_camera_frame(frame_buffer, frame_size);
- 
-         // Calculate time spent processing and delay for consistent FPS
-         struct timespec current_time;
-         clock_gettime(CLOCK_MONOTONIC, &current_time);
-         
-         long elapsed_ns = (current_time.tv_sec - frame_time.tv_sec) * 1000000000 +
-                           (current_time.tv_nsec - frame_time.tv_nsec);
-         
-         if (elapsed_ns < frame_duration_ns) 
-         {
-             // Sleep for remaining time
-             struct timespec sleep_time;
-             sleep_time.tv_sec = 0;
-             sleep_time.tv_nsec = frame_duration_ns - elapsed_ns;
-             nanosleep(&sleep_time, NULL);
-         }
-     }
-     
-     // Clean up
-     free(frame_buffer);
-     fclose(file);
-     
-     return NULL;
- }
- 
- /******************************************************************************
- * function: start_realtime_display
- * brief: Start real-time display from a named pipe
- * 
- * This function sets up a background thread to read YUV420 frames from the
- * named pipe and display them on the OLED in real-time. It creates the pipe
- * if it doesn't already exist.
- *
- * returns 0 on success, -1 on failure 
- *
- * errors:
- *   - if display is already active
- *   - pipe creation fails
- *   - thread creation fails
- ******************************************************************************/
- int start_realtime_display(void) 
- {
-     if (display_active) 
-     {
-         fprintf(stderr, "Display already active\n");
-         return -1;
-     }
-     
-     // Create pipe if it doesn't exist
-     struct stat st;
-     if (stat(PIPE_PATH, &st) != 0) 
-     {
-         if (mkfifo(PIPE_PATH, 0666) != 0) 
-         {
-             perror("Failed to create FIFO pipe");
-             return -1;
-         }
-         pipe_created = 1;
-     }
-     
-     // Set flag and create thread
-     display_active = 1;
-     
-     // Create thread for pipe reading
-     if (pthread_create(&display_thread, NULL, pipe_thread_func, NULL) != 0) 
-     {
-         perror("Failed to create display thread");
-         display_active = 0;
-         return -1;
-     }
-     
-     return 0;
- }
- 
- /******************************************************************************
- * function: pipe_thread_func
- * brief: Thread function for pipe reading
- *
- * This function runs in a separate thread and handles reading YUV420 frames
- * from the named pipe and displaying them on the OLED. It maintains statistics
- * about frames received and display performance.
- *
- * Parameters:
- *   arg - Unused parameter (required by pthread API)
- *
- * returns NULL on completion
- ******************************************************************************/
- static void* pipe_thread_func(void* arg)
- {
-     printf("Pipe thread starting, opening pipe: %s\n", PIPE_PATH);
-     int pipe_fd = open(PIPE_PATH, O_RDONLY);
- 
-     if (pipe_fd < 0)
-     {
-         perror("Failed to open pipe");
-         display_active = 0;
-         return NULL;
-     }
- 
-     printf("Pipe opened successfully (fd = %d)\n", pipe_fd);
- 
-     // Allocate frame buffer for YUV data (using double buffering)
-     size_t frame_size = OLED_WIDTH * OLED_HEIGHT * 3 / 2; // YUV420 size
-     //uint8_t* frame_buffer = malloc(frame_size);
-     uint8_t* frame_buffers[2] = {NULL, NULL}; // two buffers for double buffering
-     frame_buffers[0] = malloc(frame_size);
-     if (!frame_buffers[0])
-     {
-         perror("Failed to allocate first frame buffer");
-         close(pipe_fd);
-         display_active = 0;
-         return NULL;
-     }
- 
-     frame_buffers[1] = malloc(frame_size);
-     if (!frame_buffers[1])
-     {
-         perror("Failed to allocate second frame buffer");
-         free(frame_buffers[0]);
-         close(pipe_fd);
-         display_active = 0;
-         return NULL;
-     }
-     
-     // if (!frame_buffers[0] || !frame_buffers[1]) 
-     // {
-     //     perror("Failed to allocate frame buffers");
-     //     if(frame_buffers[0])
-     //     {
-     //         free(frame_buffers[0]);
-     //     }
- 
-     //     if(frame_buffers[1])
-     //     {
-     //         free(frame_buffers[1]);
-     //     }
- 
-     //     close(pipe_fd);
-     //     display_active = 0;
-     //     return NULL;
-     // }
- 
-     printf("Double frame buffer allocated, size=%zu bytes\n", frame_size);
-     printf("Waiting for data from camera...\n");
- 
-     int frames_received = 0;
-     time_t start_time = time(NULL);
-     int active_buffer = 0; // check status of the active buffer
-     
-     // initially filling the first buffer
-     size_t total_read = 0;
-     while(total_read < frame_size && display_active)
-     {
-         ssize_t bytes_read = read(pipe_fd, frame_buffers[0] + total_read, frame_size - total_read);
- 
-         if(bytes_read <= 0)
-         {
-             if (bytes_read < 0) 
-             {
-                 perror("Error reading from pipe");
-             } 
-             else 
-             {
-                 printf("Pipe closed by writer\n");
-             }
-             
-             // Break out of the inner loop on error
-             break;
-         }
- 
-         total_read += bytes_read;
-     }
- 
-     if (total_read < frame_size) 
-     {
-         fprintf(stderr, "Incomplete first frame (%zu/%zu bytes)...exiting\n", total_read, frame_size);
-         free(frame_buffers[0]);
-         free(frame_buffers[1]);
-         close(pipe_fd);
-         display_active = 0;
-         return NULL;
-     }
-     
-     frames_received++;
- 
-     while (display_active) 
-     {
-         // read complete frames
-         //size_t total_read = 0;
-         display_camera_frame(frame_buffers[active_buffer], frame_size);
- 
-         // While displaying the current buffer, read the next frame into the other buffer
-         int next_buffer = 1 - active_buffer; // Switch buffers (0->1, 1->0)
-         total_read = 0;
- 
-         while(total_read < frame_size && display_active)
-         {
-             ssize_t bytes_read = read(pipe_fd, frame_buffers[next_buffer] + total_read, frame_size - total_read);
- 
-             if(bytes_read <= 0)
-             {
-                 if (bytes_read < 0) 
-                 {
-                     perror("Error reading from pipe");
-                 } 
-                 else 
-                 {
-                     printf("Pipe closed by writer\n");
-                 }
-                 
-                 // Break out of the inner loop on error
-                 break;
-             }
- 
-             total_read += bytes_read;
-         }
-         
-         // if we did not get a complete frame, exit the thread
-         if (total_read < frame_size) 
-         {
-             fprintf(stderr, "Incomplete frame (%zu/%zu bytes)...exiting\n", total_read, frame_size);
-             break;
-         }
- 
-         // using new function to display on OLED
-         //display_camera_frame(frame_buffer, frame_size);
-         // switch to the newly filled buffer for the next iteration
-         active_buffer = next_buffer;
- 
-         // successfully read a complete frame
-         frames_received++;
-         if (frames_received % 300 == 0) 
-         {  // Log every 300 frames
-             time_t now = time(NULL);
-             float elapsed = now - start_time;
-             if(elapsed > 0)
-             {
-                 printf("\nReceived %d frames in %.1f seconds (%.2f FPS)\n", 
-                     frames_received, elapsed, frames_received / elapsed);
-             }
-         }
-     }
-        
-     //free(oled_buffer);
-     free(frame_buffers[0]);
-     free(frame_buffers[1]);
- 
-     // closing the file descriptor
-     if(pipe_fd >= 0)
-     {
-         close(pipe_fd);
-     }
- 
-     printf("Pipe thread exiting, received %d frames total\n", frames_received);
-     
-     return NULL;
- }
- 
- /******************************************************************************
- * function: display_camera_frame
- * brief: Process and display a camera frame on OLED
- * 
- * Takes a raw YUV420 frame, converts it to RGB565 format and displays it on 
- * the connected OLED display. This function handles the colorspace conversion
- * for each pixel and formats the data properly for the OLED driver.
- *
- *Parameters:
- *   frame_buffer - Pointer to YUV420 frame data buffer
- *   frame_size - Size of the frame data in bytes (must be at least OLED_WIDTH * OLED_HEIGHT * 3/2)
- *
- ******************************************************************************/
- void display_camera_frame(uint8_t* frame_buffer, size_t frame_size) 
- {
-     // the buffers are already pre-allocated at the top
-     //UBYTE *oled_buffer;
-     //UWORD buffer_size = (OLED_WIDTH*2) * OLED_HEIGHT;
- 
-     if((oled_buffers[0] = (UBYTE *)malloc(buffer_size)) == NULL)
-      {
-          perror("Failed to allocate OLED buffer");
-         return;
-      } 
-     
-     if((oled_buffers[1] = (UBYTE *)malloc(buffer_size)) == NULL)
-      {
-          perror("Failed to allocate OLED buffer");
-         return;
-      } 
- 
- 
-     if(oled_buffers[0] == NULL || oled_buffers[1] == NULL)
-     {
-         fprintf(stderr, "OLED buffer not initialized\n");
-         return;
-     }
- 
-     UBYTE *current_buffer1 = oled_buffers[current_buffer]; // use the current buffer for display
- 
-     // Check if data is valid
-     if (!frame_buffer || frame_size < (OLED_WIDTH * OLED_HEIGHT * 3 / 2)) 
-     {
-         fprintf(stderr, "Invalid frame data or size\n");
-         return;
-     }
-     
-     // Process YUV data to RGB565
-     uint8_t* y_plane = frame_buffer;
-     uint8_t* u_plane = y_plane + OLED_WIDTH * OLED_HEIGHT;
-     uint8_t* v_plane = u_plane + (OLED_WIDTH * OLED_HEIGHT / 4);
-     
-     // Convert YUV to RGB565 & place directly in buffer
-     for (int row = 0; row < OLED_HEIGHT; row++) 
-     {
-         for (int col = 0; col < OLED_WIDTH; col++) 
-         {
-             int y_index = row * OLED_WIDTH + col;
-             int uv_row = row / 2;
-             int uv_col = col / 2;
-             int uv_index = uv_row * (OLED_WIDTH / 2) + uv_col;
-             
-             uint8_t y_val = y_plane[y_index];
-             uint8_t u_val = u_plane[uv_index];
-             uint8_t v_val = v_plane[uv_index];
-             
-             uint8_t r, g, b;
-             yuv420_to_rgb(y_val, u_val, v_val, &r, &g, &b);
-             
-             // Convert RGB to RGB565 and draw pixel
-             UWORD color = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
-             UWORD pos = (row * OLED_WIDTH + col) * 2;
-             current_buffer1[pos] = (color >> 8) & 0xFF;
-             current_buffer1[pos+1] = color & 0xFF;
-         }
-     }
- 
-     // Process 2x2 blocks at a time (since U/V are at quarter resolution)
-     // for (int row = 0; row < OLED_HEIGHT; row += 2) {
-     //     for (int col = 0; col < OLED_WIDTH; col += 2) {
-     //         // Get shared U/V for this 2x2 block
-     //         int uv_index = (row/2) * (OLED_WIDTH/2) + (col/2);
-     //         uint8_t u_val = u_plane[uv_index];
-     //         uint8_t v_val = v_plane[uv_index];
-             
-     //         // Process all 4 pixels in the 2x2 block
-     //         for (int y_off = 0; y_off < 2; y_off++) {
-     //             for (int x_off = 0; x_off < 2; x_off++) {
-     //                 int cur_row = row + y_off;
-     //                 int cur_col = col + x_off;
-                     
-     //                 // Skip if we're outside the display bounds
-     //                 if (cur_row >= OLED_HEIGHT || cur_col >= OLED_WIDTH) continue;
-                     
-     //                 // Get Y value for this specific pixel
-     //                 int y_index = cur_row * OLED_WIDTH + cur_col;
-     //                 uint8_t y_val = y_plane[y_index];
-                     
-     //                 // Direct conversion to RGB565
-     //                 UWORD color = yuv420_to_rgb(y_val, u_val, v_val);
-                     
-     //                 // Store in buffer in the format expected by the OLED driver
-     //                 int buf_index = y_index;
-     //                 oled_buffer[buf_index] = color;
-     //             }
-     //         }
-     //     }
-     // }
-     
-     //return 
-     //OLED_1in5_rgb_Display((UBYTE *)oled_buffer);
-     OLED_1in5_rgb_Display(current_buffer1);
- 
-     // switching to the next buffer for the next frame
-     current_buffer = 1 - current_buffer;
-     
-     // Free the buffer
-     //free(oled_buffer);
-    
-     // Display the frame using Waveshare's function
-     /*return*/ 
- }
- 
- // Add this to free display buffers
- void free_display_buffers(void)
- {
-     if(oled_buffers[0] != NULL) 
-     {
-         free(oled_buffers[0]);
-         oled_buffers[0] = NULL;
-     }
-     
-     if(oled_buffers[1] != NULL) 
-     {
-         free(oled_buffers[1]);
-         oled_buffers[1] = NULL;
-     }
- }
- 
- /******************************************************************************
- * Check if a YUV file is currently being displayed
- * 
- * Returns the current state of the display thread, allowing other parts of
- * the application to determine if video playback is active.
- *
- * Returns:
- *   1 if display is active
- *   0 if display is not active
- ******************************************************************************/
- int is_display_active(void)
- {
-     return display_active;
- }
- 
- /******************************************************************************
- * Stops video playback
- * 
- * This function stops the background playback thread and sets the
- * display_active flag to 0, which signals the thread to exit.
- * It waits for the thread to complete before returning.
- ******************************************************************************/
- void stop_display(void) 
- {
-     if (display_active) 
-     {
-         display_active = 0;
-         pthread_join(display_thread, NULL);
-     }
- }
- 
- /******************************************************************************
- * Clean up OLED display resources
- * 
- * This function should be called before program exit to properly
- * shut down the display, free hardware resources, and clean up
- * any created pipes. It ensures proper termination of the display thread.
- ******************************************************************************/
- void oled_cleanup(void) 
- {
-     if (display_active) 
-     {
-         stop_display();
-     }
- 
-     // Free the global buffer if it exists
-     // if(oled_buffer != NULL) 
-     // {
-     //     free(oled_buffer);
-     //     oled_buffer = NULL;
-     // }
- 
-     // Clean up the Waveshare driver resources
-     DEV_ModuleExit();
- 
-     // Clean up pipe if it was created
-     if (pipe_created) 
-     {
-         unlink(PIPE_PATH);
-         pipe_created = 0;
-     }
- }
- 
- 
+/******************************************************************************
+* CAM_DRIVER.C
+* 
+* Implementation of the camera driver for OLED display. This file contains
+* the core functionality for controlling an SSD1351-based OLED display with
+* real-time camera input or pre-recorded YUV420 video playback.
+* 
+* The implementation provides thread-based handling of video streams, colorspace
+* conversion from YUV420 to RGB565 for display, and proper resource management
+* for the OLED hardware. It supports both file-based playback and real-time
+* streaming through a named pipe.
+*
+* Key features:
+*   - 15-30 FPS video playback paced on absolute deadlines, with a late-frame
+*     policy and frame-phase statistics (frame_sched.h)
+*   - A live frame rate that adapts to the measured conversion and SPI
+*     transfer times (fps_governor.h)
+*   - YUV420 (I420, NV12, NV21) and YUYV to RGB565 colorspace conversion
+*   - Mirrored, flipped or rotated output without an extra pass
+*   - Digital zoom and pan, resampled during conversion
+*   - Partial panel updates: only the rectangles that changed since the
+*     previous frame go over SPI
+*   - Optional interlaced updates: even rows on one frame, odd rows on
+*     the next, for about half the SPI time per frame
+*   - Gamma and dimming in the panel's gray scale table and drive
+*     currents, with day, dusk and night presets
+*   - A present thread that sends frame N while frame N+1 is converted
+*     (triple-buffered, present_queue.h)
+*   - Threaded handling of display operations
+*   - Named pipe support for real-time camera feed; the newest complete
+*     frame is always the one shown, so latency stays bounded when the
+*     panel is slower than the camera (frame_mailbox.h)
+*   - SPI interface to 128x128 OLED display
+*   - Pluggable display backends: the panel, or an emulated SSD1351 for
+*     running and timing the pipeline without hardware
+*   - Optional mirror of the shown frames, e.g. into shared memory
+*
+* Hardware requirements:
+*   - Waveshare 1.5" RGB OLED display (SSD1327 controller)
+*   - GPIO pins for controlling OLED (DC, RST, CS)
+*   - SPI interface for data transfer
+*
+* Dependencies:
+*   - lgpio.h - for GPIO control
+*   - OLED_1in5_rgb.h - Waveshare OLED driver
+*   - pthread.h - POSIX threads
+*   - linux/spi/spidev.h - Linux SPI interface
+*   - yuv_convert.h - YUV to RGB565 conversion and downscaling kernels
+*   - convert_pool.h - worker pool for multi-core frame conversion
+*   - ssd1351.h - bulk SSD1351 window/data transfers
+*   - present_queue.h - triple-buffered present thread
+*   - display_backend.h - panel backends (Waveshare OLED, SSD1351 emulator)
+*   - frame_sched.h - absolute-deadline frame pacing
+*   - frame_mailbox.h - latest-frame-wins hand-off from the camera pipe
+*   - fps_governor.h - adaptive live frame rate
+* 
+* Author: The One Project is Real!!!!
+* Date: 02/19/2025
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+ ******************************************************************************/
+ #include "cam_driver.h"         // driver header file
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <unistd.h>
+ #include <fcntl.h>              // for file control
+ #include <errno.h>
+ #include <sys/stat.h>       
+ #include <signal.h>
+ #include <time.h>
+ #include <pthread.h>
+ #include <sys/ioctl.h>	        // device-specific I/O operations
+ #include <sys/types.h>
+ #include <linux/spi/spidev.h>   // for SPI device control; transfer data to SPI peripherals
+ #include <lgpio.h>              // GPIO control
+ #include "OLED_1in5_rgb.h"      // header file for OLED
+ #include "GUI_Paint.h"          // header file for OLED colors
+ #include "test.h"
+ #include "DEV_Config.h"
+ #include "convert_pool.h"      // band-parallel frame conversion
+ #include "ssd1351.h"           // bulk SPI frame transfer
+ #include "present_queue.h"     // conversion/transfer overlap
+ #include "display_backend.h"   // panel or emulator
+ #include "frame_sched.h"       // frame pacing
+ #include "frame_mailbox.h"     // newest camera frame
+ #include "fps_governor.h"      // adaptive frame rate
+ 
+ // OLED Constants for Waveshare 1.5" OLED
+ #define OLED_WIDTH  DISPLAY_WIDTH
+ #define OLED_HEIGHT DISPLAY_HEIGHT
+ #define OLED_DC_PIN 22      // Data/Command pin (BCM numbering)
+ #define OLED_RST_PIN 13     // Reset pin
+ #define OLED_CS_PIN  24     // Chip select pin
+ 
+ // Control initialization
+ static volatile int display_active = 0;
+ static volatile int pipe_created = 0;
+ static yuv_colorimetry_t stream_colorimetry = CAMERA_COLORIMETRY;
+ static yuv_format_t stream_format = CAMERA_FORMAT;   // for the next stream
+ static yuv_format_t frame_format = CAMERA_FORMAT;    // of the running stream
+ static int stream_width = CAMERA_WIDTH;              // for the next stream
+ static int stream_height = CAMERA_HEIGHT;
+ static int frame_width = CAMERA_WIDTH;               // of the running stream
+ static int frame_height = CAMERA_HEIGHT;
+ static yuv_rect frame_crop;                          // source area shown on the panel
+ static const display_backend *display = &display_backend_oled;
+ static int display_ready = 0;                        // display->init succeeded
+ static const display_backend *mirror = NULL;         // also gets every frame
+ static int mirror_ready = 0;
+ 
+ // Pacing of the running stream; its statistics are read from other threads,
+ // so the flag is set by the stream's thread with a release store and read
+ // with an acquire load
+ static frame_sched stream_sched = FRAME_SCHED_INITIALIZER;
+ static int stream_sched_started = 0;
+ 
+ // Newest frame of the camera pipe, filled by the ingest thread; the flag
+ // is read by the statistics getters on other threads (atomic accesses)
+ static frame_mailbox live_mailbox = FRAME_MAILBOX_INITIALIZER;
+ static int live_mailbox_started = 0;
+ 
+ // Live frame rate, chosen from the measured stage costs
+ static fps_governor governor = FPS_GOVERNOR_INITIALIZER(FPS_MIN, FPS_MAX);
+ static int fps_min = FPS_MIN;
+ static int file_fps = FPS_MAX;                       // rate of the file being played
+ static int fps_max = FPS_MAX;
+ static fps_notify_fn fps_notify = NULL;
+ static frame_late_policy file_late_policy = FILE_LATE_POLICY;
+ static frame_late_policy live_late_policy = LIVE_LATE_POLICY;
+ static pthread_t display_thread;
+ 
+ // Digital zoom, set from the HUD thread and read once per frame
+ static pthread_mutex_t view_lock = PTHREAD_MUTEX_INITIALIZER;
+ static int view_zoom = ZOOM_ONE;
+ static int view_pan_x = 0;
+ static int view_pan_y = 0;
+ 
+ // Static function declarations
+ static void* display_thread_func(void* arg);
+ static void* pipe_thread_func(void* arg);
+ static void* ingest_thread_func(void* arg);
+ static void present_frame(const uint8_t *frame, void *ctx);
+ static void present_field(const uint8_t *frame);
+ static void latch_stream_geometry(void);
+ static void print_sched_stats(const char *mode);
+ static void report_fps(int fps);
+ static uint64_t monotonic_ns(void);
+ static int current_view(yuv_rect *view);
+ //static void yuv420_to_rgb(uint8_t y, uint8_t u, uint8_t v, uint8_t *r, uint8_t *g, uint8_t *b);
+ 
+ // Allocate OLED buffer (RGB565 format - 2 bytes per pixel)
+ //static UWORD *oled_buffer = NULL;
+ // The frames in flight are the present queue's buffers (triple buffering);
+ // panel_frame is the present thread's copy of the last frame it sent
+ static UBYTE *panel_frame = NULL;
+ static UWORD buffer_size = (OLED_WIDTH*2) * OLED_HEIGHT;
+ static int panel_synced = 0;            // the panel shows panel_frame
+ 
+ // Interlaced mode: field_frame is panel_frame with the rows of the field
+ // being sent replaced; the two are swapped once it is on the panel
+ static volatile int interlaced = DISPLAY_INTERLACED;
+ static UBYTE *field_frame = NULL;
+ static int next_field = 0;              // 0 = even rows, 1 = odd rows
+
+ // Held while frames or commands go to the panel, so a drive level change
+ // from another thread never lands in the middle of a transfer
+ static pthread_mutex_t panel_lock = PTHREAD_MUTEX_INITIALIZER;
+ static display_levels panel_levels;
+ static int panel_levels_set = 0;        // panel_levels replace the init ones
+
+ // Drive levels of the presets. Day keeps the levels of the Waveshare init
+ // sequence. Dusk and night lower the currents and replace the linear gray
+ // scale with a power-law one, which gives the low and middle codes shorter
+ // pulses: shadows and mid-tones get darker than the highlights, so the
+ // panel glows less in the dark while bright HUD text stays readable
+ static const display_levels preset_levels[] =
+ {
+     [DISPLAY_PRESET_DAY]   = { .gamma = 0.0, .contrast = { 0xC8, 0x80, 0xC0 }, .master = 15 },
+     [DISPLAY_PRESET_DUSK]  = { .gamma = 1.8, .contrast = { 0xC8, 0x80, 0xC0 }, .master = 8 },
+     [DISPLAY_PRESET_NIGHT] = { .gamma = 2.2, .contrast = { 0x64, 0x40, 0x60 }, .master = 3 },
+ };
+ //static UBYTE *oled_buffer = NULL;
+ 
+ /******************************************************************************
+ * function: oled_init
+ * brief: Initialize the OLED display
+ * 
+ * This function sets up the SPI interface and configures the display
+ * for proper operation with the Waveshare 1.5" OLED with SSD1352 controller.
+ * It initializes the display module, clears the screen, and allocates memory
+ * for the display buffer.
+ * 
+ * returns 0 on success, -1 on failure
+ ******************************************************************************/
+ int oled_init(void) 
+ {
+     printf("Initializing OLED display (%s)...\n", display->name);
+ 
+     // Initialize the device with driver and the OLED display
+     if(display->init() != 0) 
+     {
+         printf("Display init failed\n");
+         return -1;
+     }
+     display_ready = 1;
+ 
+     // The mirror is optional; without it the panel works as before
+     if (mirror != NULL)
+     {
+         if (mirror->init() == 0)
+         {
+             mirror_ready = 1;
+         }
+         else
+         {
+             printf("Display mirror (%s) not available\n", mirror->name);
+         }
+     }
+     
+     // Levels chosen before the panel was up, or before it was last reset
+     if (panel_levels_set && display->set_levels != NULL)
+     {
+         display->set_levels(&panel_levels);
+     }
+
+     // Clear the display to start with a blank screen
+     display->clear();
+     if (mirror_ready)
+     {
+         mirror->clear();
+     }
+     panel_synced = 0;
+ 
+     // Allocate the display buffer just once at initialization
+     //buffer_size = (OLED_WIDTH*2) * OLED_HEIGHT; // RGB565 format (2 bytes per pixel)
+     //oled_buffer = (UWORD *)malloc(buffer_size);
+     // if (oled_buffer == NULL) 
+     // {
+     //     printf("Failed to allocate display buffer\n");
+     //     return -1;
+     // }
+     if(init_display_buffers() != 0)
+     {
+         printf("Failed to initialize display buffers\n");
+         return -1;
+     }
+     
+     // Initialize buffer to all black
+     //memset(oled_buffer, 0, buffer_size);
+ 
+     // Start the conversion workers once; they sleep between frames
+     convert_pool_start(CONVERT_WORKERS);
+ 
+     printf("OLED display initialized (conversion kernel: %s)\n",
+            yuv_kernel_name(yuv_convert_active_kernel()));
+     return 0;
+ }
+ 
+ //new code for initializing the buffers at the startup of the program
+ int init_display_buffers(void)
+ {
+     buffer_size = (OLED_WIDTH*2) * OLED_HEIGHT; // RGB565 format (2 bytes per pixel)
+ 
+     if(panel_frame == NULL)
+     {
+         panel_frame = (UBYTE *)malloc(buffer_size);
+         if(panel_frame == NULL)
+         {
+             perror("Failed to allocate OLED panel copy");
+             return -1;
+         }
+         memset(panel_frame, 0, buffer_size); // Initialize to black
+         panel_synced = 0;
+     }
+ 
+     if(field_frame == NULL)
+     {
+         field_frame = (UBYTE *)malloc(buffer_size);
+         if(field_frame == NULL)
+         {
+             perror("Failed to allocate OLED field frame");
+             return -1;
+         }
+     }
+ 
+     // The frame buffers come with the present thread that sends them
+     if(present_queue_start(buffer_size, present_frame, NULL) != 0)
+     {
+         free(panel_frame);
+         panel_frame = NULL;
+         free(field_frame);
+         field_frame = NULL;
+         return -1;
+     }
+ 
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * function: start_video_display
+ * brief: Start video playback on the OLED display
+ * 
+ * This function starts a background thread that reads YUV420 frames
+ * from the specified file and displays them on the OLED at the rate the
+ * file was recorded at. The video file is played in a loop.
+ * 
+ * returns 0 on success, -1 on failure 
+ *
+ * errors: 
+ *   - if display is already active
+ *   - invalid frame rate
+ *   - file doesn't exist
+ *   - thread creation fails
+ ******************************************************************************/
+ int start_video_display(const char *yuv_filename, int fps) 
+ {
+     if (display_active) 
+     {
+         fprintf(stderr, "Display is active\n");
+         return -1;
+     }
+     if (fps < 1)
+     {
+         fprintf(stderr, "Invalid playback rate %d\n", fps);
+         return -1;
+     }
+     
+     // Check if file exists
+     FILE* test = fopen(yuv_filename, "rb");
+     if (!test) 
+     {
+         perror("Cannot open YUV file");
+         return -1;
+     }
+     fclose(test);
+     
+     // Pick the conversion variant for this stream's matrix and range
+     yuv_convert_set_colorimetry(stream_colorimetry);
+     latch_stream_geometry();
+     file_fps = fps;
+     
+     // Set flag and create thread
+     display_active = 1;
+     
+     // Create thread for playback
+     if (pthread_create(&display_thread, NULL, display_thread_func, (void*)yuv_filename) != 0) 
+     {
+         perror("Failed to create display thread");
+         display_active = 0;
+         return -1;
+     }
+     
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * function: display_thread_func
+ * brief: Thread function for file playback
+ * 
+ * This function runs in a separate thread and handles reading frames from a YUV420
+ * video file, converting them to RGB565, and displaying them on the OLED at the
+ * specified frame rate. It implements timing control to maintain constant FPS.
+ *
+ * returns NULL on completion
+ ******************************************************************************/
+ static void* display_thread_func(void* arg) 
+ {
+     const char* filename = (const char*)arg;
+     FILE* file = fopen(filename, "rb");
+     if (!file) 
+     {
+         perror("Failed to open YUV file");
+         display_active = 0;
+         return NULL;
+     }
+     
+     // Allocate frame buffer for YUV data
+     size_t frame_size = yuv_frame_size(frame_format, frame_width, frame_height);
+     uint8_t* frame_buffer = malloc(frame_size);
+     if (!frame_buffer) 
+     {
+         perror("Failed to allocate frame buffer");
+         fclose(file);
+         display_active = 0;
+         return NULL;
+     }
+ 
+     // Frames are released on a fixed timeline, so the time spent reading
+     // and converting never adds up to drift. A file plays at the rate it
+     // was recorded at (any other would change the playback speed); frames
+     // the panel cannot keep up with are skipped
+     frame_sched_start(&stream_sched, file_fps, file_late_policy);
+     __atomic_store_n(&stream_sched_started, 1, __ATOMIC_RELEASE);
+     int skip = 0;
+     
+     while (display_active) 
+     {
+         // Frames whose period was dropped are skipped to keep the picture in time
+         if (skip > 0 && fseek(file, (long)skip * (long)frame_size, SEEK_CUR) != 0)
+         {
+             rewind(file);
+         }
+         skip = 0;
+         
+         // Read a frame from the file
+         size_t bytes_read = fread(frame_buffer, 1, frame_size, file);
+         if (bytes_read < frame_size) 
+         {
+             // End of file or error, rewind to beginning
+             rewind(file);
+             continue;
+         }
+         
+         // Wait for the frame's deadline, then display it
+         skip = frame_sched_wait(&stream_sched);
+         display_camera_frame(frame_buffer, frame_size);
+     }
+     
+     print_sched_stats("Playback");
+     
+     // Clean up
+     free(frame_buffer);
+     fclose(file);
+     
+     return NULL;
+ }
+ 
+ /******************************************************************************
+ * function: start_realtime_display
+ * brief: Start real-time display from a named pipe
+ * 
+ * This function sets up a background thread to read YUV420 frames from the
+ * named pipe and display them on the OLED in real-time. It creates the pipe
+ * if it doesn't already exist.
+ *
+ * returns 0 on success, -1 on failure 
+ *
+ * errors:
+ *   - if display is already active
+ *   - pipe creation fails
+ *   - thread creation fails
+ ******************************************************************************/
+ int start_realtime_display(void) 
+ {
+     if (display_active) 
+     {
+         fprintf(stderr, "Display already active\n");
+         return -1;
+     }
+     
+     // Create pipe if it doesn't exist
+     struct stat st;
+     if (stat(PIPE_PATH, &st) != 0) 
+     {
+         if (mkfifo(PIPE_PATH, 0666) != 0) 
+         {
+             perror("Failed to create FIFO pipe");
+             return -1;
+         }
+         pipe_created = 1;
+     }
+     
+     // Pick the conversion variant for this stream's matrix and range
+     yuv_convert_set_colorimetry(stream_colorimetry);
+     latch_stream_geometry();
+     printf("Stream format: %s %dx%d, colorimetry: %s\n", yuv_format_name(frame_format),
+            frame_width, frame_height, yuv_colorimetry_name(stream_colorimetry));
+     
+     // Set flag and create thread
+     display_active = 1;
+     
+     // Create thread for pipe reading
+     if (pthread_create(&display_thread, NULL, pipe_thread_func, NULL) != 0) 
+     {
+         perror("Failed to create display thread");
+         display_active = 0;
+         return -1;
+     }
+     
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * function: read_pipe_frame
+ * brief: Read one complete frame from the pipe
+ *
+ * returns 0 on success, -1 if the pipe closed or failed mid-frame
+ ******************************************************************************/
+ static int read_pipe_frame(int pipe_fd, uint8_t *frame, size_t frame_size)
+ {
+     size_t total_read = 0;
+ 
+     while(total_read < frame_size && display_active)
+     {
+         ssize_t bytes_read = read(pipe_fd, frame + total_read, frame_size - total_read);
+ 
+         if(bytes_read <= 0)
+         {
+             if (bytes_read < 0) 
+             {
+                 perror("Error reading from pipe");
+             } 
+             else 
+             {
+                 printf("Pipe closed by writer\n");
+             }
+             break;
+         }
+ 
+         total_read += bytes_read;
+     }
+ 
+     // A writer closing between frames is the normal end of the stream
+     if (total_read > 0 && total_read < frame_size && display_active)
+     {
+         fprintf(stderr, "Incomplete frame (%zu/%zu bytes)...exiting\n", total_read, frame_size);
+     }
+     return (total_read < frame_size) ? -1 : 0;
+ }
+ 
+ /******************************************************************************
+ * function: ingest_thread_func
+ * brief: Thread function that drains the pipe into the live mailbox
+ *
+ * Reads frames as fast as the camera writes them, so the pipe never fills
+ * up behind a slow panel; each complete frame replaces the one waiting in
+ * the mailbox. Closes the mailbox when the stream ends.
+ *
+ * Parameters:
+ *   arg - pointer to the pipe's file descriptor
+ *
+ * returns NULL on completion
+ ******************************************************************************/
+ static void* ingest_thread_func(void* arg)
+ {
+     int pipe_fd = *(int *)arg;
+     size_t frame_size = yuv_frame_size(frame_format, frame_width, frame_height);
+     time_t start_time = time(NULL);
+ 
+     while (display_active &&
+            read_pipe_frame(pipe_fd, frame_mailbox_buffer(&live_mailbox), frame_size) == 0)
+     {
+         frame_mailbox_publish(&live_mailbox);
+ 
+         frame_mailbox_stats s;
+         frame_mailbox_get_stats(&live_mailbox, &s);
+         if (s.published % 300 == 0) 
+         {  // Log every 300 frames
+             float elapsed = time(NULL) - start_time;
+             if(elapsed > 0)
+             {
+                 printf("\nReceived %llu frames in %.1f seconds (%.2f FPS), %llu dropped\n", 
+                     (unsigned long long)s.published, elapsed, s.published / elapsed,
+                     (unsigned long long)s.dropped);
+             }
+         }
+     }
+ 
+     frame_mailbox_close(&live_mailbox);
+     return NULL;
+ }
+ 
+ /******************************************************************************
+ * function: pipe_thread_func
+ * brief: Thread function for pipe reading
+ *
+ * This function runs in a separate thread and displays the YUV frames that
+ * arrive on the named pipe. The pipe itself is read by an ingest thread
+ * into the live mailbox (frame_mailbox.h), and this thread always shows the
+ * newest complete frame: when SPI is slower than the camera, the frames in
+ * between are dropped and counted instead of queueing up, so the picture
+ * stays as close to real time as the panel allows.
+ *
+ * Parameters:
+ *   arg - Unused parameter (required by pthread API)
+ *
+ * returns NULL on completion
+ ******************************************************************************/
+ static void* pipe_thread_func(void* arg)
+ {
+     printf("Pipe thread starting, opening pipe: %s\n", PIPE_PATH);
+     int pipe_fd = open(PIPE_PATH, O_RDONLY);
+ 
+     if (pipe_fd < 0)
+     {
+         perror("Failed to open pipe");
+         display_active = 0;
+         return NULL;
+     }
+ 
+     printf("Pipe opened successfully (fd = %d)\n", pipe_fd);
+ 
+     // Frames are read into the mailbox and displayed straight from it
+     size_t frame_size = yuv_frame_size(frame_format, frame_width, frame_height);
+     if (frame_mailbox_open(&live_mailbox, frame_size) != 0)
+     {
+         close(pipe_fd);
+         display_active = 0;
+         return NULL;
+     }
+     __atomic_store_n(&live_mailbox_started, 1, __ATOMIC_RELEASE);
+ 
+     pthread_t ingest_thread;
+     if (pthread_create(&ingest_thread, NULL, ingest_thread_func, &pipe_fd) != 0)
+     {
+         perror("Failed to create ingest thread");
+         frame_mailbox_free(&live_mailbox);
+         close(pipe_fd);
+         display_active = 0;
+         return NULL;
+     }
+ 
+     printf("Frame mailbox allocated, %d x %zu bytes\n", FRAME_MAILBOX_BUFFERS, frame_size);
+     printf("Waiting for data from camera...\n");
+ 
+     // The camera sets the pace, starting with its first frame; the timeline
+     // evens out its jitter, and a frame that arrives late has nothing to skip.
+     // The governor starts from the rate it settled on last time
+     const uint8_t *frame = frame_mailbox_take(&live_mailbox);
+     fps_governor_reset(&governor, fps_min, fps_max, get_display_fps());
+     int fps = get_display_fps();
+     frame_sched_start(&stream_sched, fps, live_late_policy);
+     __atomic_store_n(&stream_sched_started, 1, __ATOMIC_RELEASE);
+     report_fps(fps);
+ 
+     while (frame != NULL && display_active) 
+     {
+         display_camera_frame((uint8_t *)frame, frame_size);
+ 
+         // Retune the rate to what conversion and transfer sustain
+         int next_fps = fps_governor_update(&governor);
+         if (next_fps != fps)
+         {
+             fps = next_fps;
+             frame_sched_set_rate(&stream_sched, fps);
+             report_fps(fps);
+         }
+ 
+         // At the next deadline, show whatever frame is newest by then
+         frame_sched_wait(&stream_sched);
+         frame = frame_mailbox_take(&live_mailbox);
+     }
+ 
+     // The ingest thread ends once the pipe closes, or after its current
+     // read when the display is stopped
+     pthread_join(ingest_thread, NULL);
+     frame_mailbox_free(&live_mailbox);
+     close(pipe_fd);
+ 
+     frame_mailbox_stats s;
+     frame_mailbox_get_stats(&live_mailbox, &s);
+     printf("Pipe thread exiting, received %llu frames total, %llu shown, %llu dropped\n",
+            (unsigned long long)s.published, (unsigned long long)s.taken,
+            (unsigned long long)s.dropped);
+     print_sched_stats("Live");
+     
+     return NULL;
+ }
+ 
+ /******************************************************************************
+ * function: display_camera_frame
+ * brief: Process and display a camera frame on OLED
+ * 
+ * Takes a raw frame in the stream's layout (I420, NV12, NV21 or YUYV),
+ * converts it to RGB565 format and displays it on the connected OLED
+ * display. This function handles the colorspace conversion for each pixel
+ * and formats the data properly for the OLED driver.
+ *
+ *Parameters:
+ *   frame_buffer - Pointer to frame data buffer
+ *   frame_size - Size of the frame data in bytes (must be at least
+ *                yuv_frame_size of the stream format at OLED resolution)
+ *
+ ******************************************************************************/
+ void display_camera_frame(uint8_t* frame_buffer, size_t frame_size) 
+ {
+     // the buffers and conversion workers are set up by oled_init; callers
+     // that bring the panel up themselves get them on the first frame
+     if(!present_queue_running())
+     {
+         if(init_display_buffers() != 0)
+         {
+             fprintf(stderr, "OLED buffer not initialized\n");
+             return;
+         }
+         convert_pool_start(CONVERT_WORKERS);
+     }
+ 
+     // Check if data is valid
+     if (!frame_buffer || frame_size < yuv_frame_size(frame_format, frame_width, frame_height)) 
+     {
+         fprintf(stderr, "Invalid frame data or size\n");
+         return;
+     }
+ 
+     // A free buffer, while the previous frame may still be going out on SPI;
+     // waits only when a converted frame is already queued behind it
+     UBYTE *current_buffer1 = present_queue_acquire();
+     
+     // Convert YUV to RGB565 & place directly in buffer. 4:2:0 frames are done
+     // in 2x2 blocks: U/V terms are computed once per block and both output
+     // rows are written together (NEON does 16x2 pixels per step when
+     // available). Bands run on the worker pool and this returns only when
+     // all are done, so the buffer is complete before it goes to the display.
+     // Larger captures and zoomed views are resampled in the same pass.
+     int converted;
+     yuv_rect view;
+     uint64_t start_ns = monotonic_ns();
+     if (!current_view(&view) && frame_width == OLED_WIDTH && frame_height == OLED_HEIGHT)
+     {
+         converted = yuv_frame_to_rgb565(frame_buffer, frame_format, OLED_WIDTH, OLED_HEIGHT, current_buffer1);
+     }
+     else
+     {
+         converted = yuv_frame_scale_to_rgb565(frame_buffer, frame_format, frame_width, frame_height,
+                                               &view, current_buffer1, OLED_WIDTH, OLED_HEIGHT);
+     }
+     if (converted != 0)
+     {
+         present_queue_release(current_buffer1);
+         return;
+     }
+     fps_governor_add_convert(&governor, monotonic_ns() - start_ns);
+ 
+     //return 
+     //OLED_1in5_rgb_Display((UBYTE *)oled_buffer);
+     // Hand the frame to the present thread and go back for the next one
+     present_queue_submit(current_buffer1);
+     
+     // Free the buffer
+     //free(oled_buffer);
+    
+     // Display the frame using Waveshare's function
+     /*return*/ 
+ }
+ 
+ /******************************************************************************
+ * function: display_rgb565_frame
+ * brief: Show a finished RGB565 image (e.g. the HUD) on the OLED
+ * 
+ * The image is copied into a free OLED buffer and queued like a camera
+ * frame, so only what changed since the last frame goes to the panel and
+ * the caller can draw the next frame while this one is sent.
+ *
+ *Parameters:
+ *   image - big-endian RGB565 image of OLED_WIDTH x OLED_HEIGHT pixels
+ *
+ ******************************************************************************/
+ void display_rgb565_frame(const UBYTE *image)
+ {
+     if(!present_queue_running())
+     {
+         if(init_display_buffers() != 0)
+         {
+             fprintf(stderr, "OLED buffer not initialized\n");
+             return;
+         }
+     }
+ 
+     UBYTE *buffer = present_queue_acquire();
+     memcpy(buffer, image, buffer_size);
+     present_queue_submit(buffer);
+ }
+ 
+ /******************************************************************************
+ * function: present_frame
+ * brief: Send a queued frame to the panel (present thread)
+ * 
+ * panel_frame holds the frame last sent, so diffing against it tile by tile
+ * gives the rectangles that changed, and a repeated frame (a static HUD, a
+ * paused stream) costs no SPI time at all. Until a frame has been sent the
+ * panel content is unknown and the whole frame goes out. The copy is kept
+ * here rather than in the queue because the queue reuses a buffer as soon
+ * as it has been sent.
+ ******************************************************************************/
+ static void present_frame(const uint8_t *frame, void *ctx)
+ {
+     (void)ctx;
+     uint64_t start_ns = monotonic_ns();
+ 
+     pthread_mutex_lock(&panel_lock);
+     // Streams only: a field left behind by the last frame would stay on
+     // the panel until the next one
+     if (interlaced && panel_synced && display_active)
+     {
+         present_field(frame);
+     }
+     else
+     {
+         display->display(frame, panel_synced ? panel_frame : NULL);
+         if (mirror_ready)
+         {
+             mirror->display(frame, panel_synced ? panel_frame : NULL);
+         }
+         memcpy(panel_frame, frame, buffer_size);
+         panel_synced = 1;
+     }
+     pthread_mutex_unlock(&panel_lock);
+     fps_governor_add_present(&governor, monotonic_ns() - start_ns);
+ }
+ 
+ /******************************************************************************
+ * function: present_field
+ * brief: Send one field of a frame to the panel (present thread)
+ * 
+ * The fields alternate from frame to frame. Afterwards the panel shows
+ * field_frame: the new frame's rows of this field and the previous rows
+ * of the other, which is also what a mirror and a backend without field
+ * updates are given.
+ ******************************************************************************/
+ static void present_field(const uint8_t *frame)
+ {
+     int field = next_field;
+ 
+     memcpy(field_frame, panel_frame, buffer_size);
+     for (int y = field; y < OLED_HEIGHT; y += 2)
+     {
+         memcpy(field_frame + y * OLED_WIDTH * 2, frame + y * OLED_WIDTH * 2, OLED_WIDTH * 2);
+     }
+ 
+     if (display->display_field != NULL)
+     {
+         display->display_field(frame, panel_frame, field);
+     }
+     else
+     {
+         display->display(field_frame, panel_frame);
+     }
+     if (mirror_ready)
+     {
+         mirror->display(field_frame, panel_frame);
+     }
+ 
+     UBYTE *shown = field_frame;
+     field_frame = panel_frame;
+     panel_frame = shown;
+     next_field = !field;
+ }
+ 
+ // Add this to free display buffers
+ void free_display_buffers(void)
+ {
+     // Frames still queued are sent before the thread exits
+     present_queue_stop();
+ 
+     if(panel_frame != NULL) 
+     {
+         free(panel_frame);
+         panel_frame = NULL;
+     }
+     free(field_frame);
+     field_frame = NULL;
+     panel_synced = 0;
+ }
+ 
+ /******************************************************************************
+ * Check if a YUV file is currently being displayed
+ * 
+ * Returns the current state of the display thread, allowing other parts of
+ * the application to determine if video playback is active.
+ *
+ * Returns:
+ *   1 if display is active
+ *   0 if display is not active
+ ******************************************************************************/
+ int is_display_active(void)
+ {
+     return display_active;
+ }
+ 
+ /******************************************************************************
+ * Get the luma statistics of the last frame put on the display
+ * 
+ * The conversion engine publishes them as each frame finishes converting,
+ * so this is only a copy; no pass over the frame is made here.
+ *
+ * Returns:
+ *   0 on success
+ *  -1 if no frame has been converted yet
+ ******************************************************************************/
+ int get_display_luma_stats(yuv_luma_stats *stats)
+ {
+     return yuv_convert_luma_stats(stats);
+ }
+ 
+ /******************************************************************************
+ * Get the pacing statistics of the running (or last) stream
+ * 
+ * Phase is how long after its deadline on the frame timeline each frame
+ * was released: the wake-up latency for frames on time, the delay for late
+ * ones. Mean and deviation show how evenly the frames are spaced.
+ *
+ * Returns:
+ *   0 on success
+ *  -1 if no stream has been started yet
+ ******************************************************************************/
+ int get_frame_sched_stats(frame_sched_stats *stats)
+ {
+     if (!__atomic_load_n(&stream_sched_started, __ATOMIC_ACQUIRE))
+     {
+         return -1;
+     }
+     frame_sched_get_stats(&stream_sched, stats);
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * Get the frame counts of the running (or last) camera stream
+ * 
+ * Frames the camera delivered while the panel was still busy with an
+ * earlier one are dropped in favour of the newest; a high drop count means
+ * the panel (or SPI clock) cannot keep up with the camera's rate.
+ *
+ * Returns:
+ *   0 on success
+ *  -1 if no camera stream has been started yet
+ ******************************************************************************/
+ int get_live_frame_stats(frame_mailbox_stats *stats)
+ {
+     if (!__atomic_load_n(&live_mailbox_started, __ATOMIC_ACQUIRE))
+     {
+         return -1;
+     }
+     frame_mailbox_get_stats(&live_mailbox, stats);
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * function: print_sched_stats
+ * brief: Log the pacing statistics when a stream ends
+ ******************************************************************************/
+ static void print_sched_stats(const char *mode)
+ {
+     frame_sched_stats s;
+ 
+     frame_sched_get_stats(&stream_sched, &s);
+     printf("%s pacing (%s): %llu frames, %llu late, %llu skipped, %llu slips, "
+            "phase %.2f/%.2f/%.2f ms (min/mean/max), jitter %.2f ms\n",
+            mode, frame_late_policy_name(stream_sched.policy),
+            (unsigned long long)s.frames, (unsigned long long)s.late,
+            (unsigned long long)s.skipped, (unsigned long long)s.slips,
+            s.phase_min_ns / 1e6, s.phase_mean_ns / 1e6, s.phase_max_ns / 1e6,
+            s.phase_stddev_ns / 1e6);
+ }
+ 
+ /******************************************************************************
+ * Get the frame rate currently chosen by the governor
+ * 
+ * Returns:
+ *   frames per second
+ ******************************************************************************/
+ int get_display_fps(void)
+ {
+     fps_governor_stats s;
+ 
+     fps_governor_get_stats(&governor, &s);
+     return s.fps;
+ }
+ 
+ /******************************************************************************
+ * Get the governor's rate and the stage costs it is based on
+ * 
+ * Returns:
+ *   0 on success
+ *  -1 if no camera stream has been started yet
+ ******************************************************************************/
+ int get_fps_governor_stats(fps_governor_stats *stats)
+ {
+     if (!__atomic_load_n(&live_mailbox_started, __ATOMIC_ACQUIRE))
+     {
+         return -1;
+     }
+     fps_governor_get_stats(&governor, stats);
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * Set the range of the live frame rate
+ * 
+ * The governor is reset to the new range at once; a running stream picks
+ * up the clamped rate at the governor's next decision.
+ *
+ * Returns:
+ *   0 on success
+ *  -1 for an invalid range
+ ******************************************************************************/
+ int set_fps_range(int min_fps, int max_fps)
+ {
+     if (min_fps < 1 || max_fps < min_fps)
+     {
+         fprintf(stderr, "Invalid frame-rate range %d-%d\n", min_fps, max_fps);
+         return -1;
+     }
+     fps_min = min_fps;
+     fps_max = max_fps;
+     fps_governor_reset(&governor, min_fps, max_fps, get_display_fps());
+     printf("Frame-rate range: %d-%d FPS\n", min_fps, max_fps);
+     return 0;
+ }
+ 
+ void set_fps_notify(fps_notify_fn fn)
+ {
+     fps_notify = fn;
+ }
+ 
+ /******************************************************************************
+ * function: report_fps
+ * brief: Log a new live frame rate and tell the capture side
+ ******************************************************************************/
+ static void report_fps(int fps)
+ {
+     fps_governor_stats s;
+ 
+     fps_governor_get_stats(&governor, &s);
+     if (s.present_ns > 0.0)
+     {
+         printf("Frame rate: %d FPS (convert %.2f ms, transfer %.2f ms per frame)\n",
+                fps, s.convert_ns / 1e6, s.present_ns / 1e6);
+     }
+     else
+     {
+         printf("Frame rate: %d FPS (range %d-%d)\n", fps, s.min_fps, s.max_fps);
+     }
+     if (fps_notify != NULL)
+     {
+         fps_notify(fps);
+     }
+ }
+ 
+ static uint64_t monotonic_ns(void)
+ {
+     struct timespec t;
+ 
+     clock_gettime(CLOCK_MONOTONIC, &t);
+     return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+ }
+ 
+ /******************************************************************************
+ * Set the late-frame policy of the streams started from now on
+ * 
+ * Returns:
+ *   0 on success, -1 for an unknown policy
+ ******************************************************************************/
+ int set_frame_late_policy(int live, frame_late_policy policy)
+ {
+     if (policy != FRAME_LATE_SKIP && policy != FRAME_LATE_CATCH_UP && policy != FRAME_LATE_SLIP)
+     {
+         fprintf(stderr, "Unknown late-frame policy %d\n", (int)policy);
+         return -1;
+     }
+     if (live)
+     {
+         live_late_policy = policy;
+     }
+     else
+     {
+         file_late_policy = policy;
+     }
+     printf("%s late-frame policy: %s\n", live ? "Live" : "Playback", frame_late_policy_name(policy));
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * Set the colorimetry of the streams started from now on
+ * 
+ * Only recorded here; start_video_display and start_realtime_display hand it
+ * to the conversion engine once per stream.
+ *
+ * Returns:
+ *   0 on success
+ *  -1 for an unknown colorimetry
+ ******************************************************************************/
+ int set_stream_colorimetry(yuv_colorimetry_t colorimetry)
+ {
+     if ((int)colorimetry < 0 || colorimetry >= YUV_COLORIMETRY_COUNT)
+     {
+         fprintf(stderr, "Unknown colorimetry %d\n", (int)colorimetry);
+         return -1;
+     }
+     stream_colorimetry = colorimetry;
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * Set the frame layout of the streams started from now on
+ * 
+ * The running stream keeps its layout; the next start_video_display or
+ * start_realtime_display latches this one for its reader and conversion.
+ *
+ * Returns:
+ *   0 on success
+ *  -1 for an unknown format
+ ******************************************************************************/
+ int set_stream_format(yuv_format_t format)
+ {
+     if (yuv_frame_size(format, OLED_WIDTH, OLED_HEIGHT) == 0)
+     {
+         fprintf(stderr, "Unknown frame format %d\n", (int)format);
+         return -1;
+     }
+     stream_format = format;
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * Set the orientation of the picture on the panel
+ * 
+ * Goes straight to the conversion engine, which picks it up with the next
+ * frame; the kernels write each pixel at its oriented position.
+ *
+ * Returns:
+ *   0 on success
+ *  -1 for an unknown orientation
+ ******************************************************************************/
+ int set_display_orientation(yuv_orientation_t orientation)
+ {
+     if (yuv_convert_set_orientation(orientation) != 0)
+     {
+         return -1;
+     }
+     printf("Display orientation: %s\n", yuv_orientation_name(orientation));
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * Switch the grayscale (night) mode on or off
+ * 
+ * Like the orientation it goes straight to the conversion engine and applies
+ * from the next frame; the luma-only kernels leave the chroma planes unread.
+ *
+ * Returns:
+ *   0 always
+ ******************************************************************************/
+ int set_display_grayscale(int enable)
+ {
+     yuv_convert_set_grayscale(enable);
+     printf("Display mode: %s\n", yuv_convert_grayscale() ? "grayscale" : "color");
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * Switch the interlaced update mode on or off
+ * 
+ * Read by the present thread for each frame, so it applies from the next
+ * frame; the panel contents stay known either way, and switching back to
+ * whole frames sends only what differs.
+ *
+ * Returns:
+ *   0 always
+ ******************************************************************************/
+ int set_display_interlaced(int enable)
+ {
+     interlaced = (enable != 0);
+     printf("Display updates: %s\n", interlaced ? "interlaced" : "whole frames");
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * Select the display backend
+ * 
+ * The backend is brought up by oled_init and shut down by oled_cleanup, so
+ * it can only be changed while neither is in effect.
+ *
+ * Returns:
+ *   0 on success, -1 if the current backend is in use
+ ******************************************************************************/
+ int set_display_backend(const display_backend *backend)
+ {
+     if (display_ready || present_queue_running())
+     {
+         fprintf(stderr, "Display backend in use, call oled_cleanup first\n");
+         return -1;
+     }
+     display = backend;
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * Select a backend that gets every frame shown, next to the display
+ * 
+ * It runs on the present thread right after the display backend, so it
+ * should be quick (the shared-memory one copies the frame once). Like the
+ * display backend it is set up by oled_init and shut down by oled_cleanup.
+ *
+ * Returns:
+ *   0 on success, -1 if the current one is in use
+ ******************************************************************************/
+ int set_display_mirror(const display_backend *backend)
+ {
+     if (mirror_ready || present_queue_running())
+     {
+         fprintf(stderr, "Display mirror in use, call oled_cleanup first\n");
+         return -1;
+     }
+     mirror = backend;
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * Set the SPI clock of the display transfers
+ * 
+ * Goes to the display backend; on spidev the clock travels with every
+ * transfer, so the running present thread picks it up with its next message
+ * and nothing has to be reopened.
+ *
+ * Returns:
+ *   0 on success, -1 for a zero clock
+ ******************************************************************************/
+ int set_display_spi_clock(uint32_t hz)
+ {
+     if (hz == 0)
+     {
+         fprintf(stderr, "Invalid SPI clock\n");
+         return -1;
+     }
+     display->set_spi_clock(hz);
+     printf("OLED SPI clock: %u Hz\n", (unsigned)hz);
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * Program the drive levels of the panel
+ * 
+ * The levels are kept and sent again by the next oled_init. While the
+ * present thread runs they go out between two frames (panel_lock). A
+ * backend without drive levels (shared memory, framebuffer) keeps its
+ * picture; so does a mirror.
+ *
+ * Returns:
+ *   0 on success
+ *  -1 for missing or invalid levels (a NaN gamma included) or a display
+ *     backend without drive levels
+ ******************************************************************************/
+ int set_display_levels(const display_levels *levels)
+ {
+     // Written so that a NaN gamma fails the range test
+     if (levels == NULL ||
+         !(levels->gamma >= 0.0 && levels->gamma <= DISPLAY_GAMMA_MAX) ||
+         levels->master > SSD1351_MASTER_MAX)
+     {
+         fprintf(stderr, "Invalid display levels\n");
+         return -1;
+     }
+     if (display->set_levels == NULL)
+     {
+         fprintf(stderr, "Display backend %s has no drive levels\n", display->name);
+         return -1;
+     }
+
+     pthread_mutex_lock(&panel_lock);
+     panel_levels = *levels;
+     panel_levels_set = 1;
+     if (display_ready)
+     {
+         display->set_levels(levels);
+     }
+     if (mirror_ready && mirror->set_levels != NULL)
+     {
+         mirror->set_levels(levels);
+     }
+     pthread_mutex_unlock(&panel_lock);
+     return 0;
+ }
+
+ /******************************************************************************
+ * Switch the panel to the drive levels of a preset
+ *
+ * Returns:
+ *   0 on success, -1 for an unknown preset or a backend without drive levels
+ ******************************************************************************/
+ int set_display_preset(display_preset preset)
+ {
+     if ((unsigned)preset >= sizeof(preset_levels) / sizeof(preset_levels[0]))
+     {
+         fprintf(stderr, "Invalid display preset\n");
+         return -1;
+     }
+     if (set_display_levels(&preset_levels[preset]) != 0)
+     {
+         return -1;
+     }
+     printf("Display levels: %s\n", display_preset_name(preset));
+     return 0;
+ }
+
+ const char *display_preset_name(display_preset preset)
+ {
+     switch (preset)
+     {
+     case DISPLAY_PRESET_DAY:
+         return "day";
+     case DISPLAY_PRESET_DUSK:
+         return "dusk";
+     case DISPLAY_PRESET_NIGHT:
+         return "night";
+     default:
+         return "unknown";
+     }
+ }
+
+ /******************************************************************************
+ * Zoom into a region of the camera picture
+ * 
+ * Only records the zoom and pan; display_camera_frame turns them into the
+ * source region of each frame (current_view).
+ *
+ * Returns:
+ *   0 on success
+ *  -1 for a zoom outside [ZOOM_ONE, ZOOM_MAX]
+ ******************************************************************************/
+ int set_display_zoom(int zoom, int pan_x, int pan_y)
+ {
+     if (zoom < ZOOM_ONE || zoom > ZOOM_MAX)
+     {
+         fprintf(stderr, "Unsupported zoom %d/%d\n", zoom, ZOOM_ONE);
+         return -1;
+     }
+ 
+     pthread_mutex_lock(&view_lock);
+     view_zoom = zoom;
+     view_pan_x = pan_x;
+     view_pan_y = pan_y;
+     pthread_mutex_unlock(&view_lock);
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * function: current_view
+ * brief: Source region shown on the panel for the next frame
+ * 
+ * The stream's aspect-fitted area (frame_crop) shrunk by the zoom, moved by
+ * the pan and clamped to the frame. Origin and size stay even so the region
+ * starts on a 2x2 chroma block.
+ *
+ * returns 1 if the view is zoomed in or panned, 0 if it is frame_crop
+ ******************************************************************************/
+ static int current_view(yuv_rect *view)
+ {
+     pthread_mutex_lock(&view_lock);
+     int zoom = view_zoom;
+     int pan_x = view_pan_x;
+     int pan_y = view_pan_y;
+     pthread_mutex_unlock(&view_lock);
+ 
+     *view = frame_crop;
+     if (zoom == ZOOM_ONE && pan_x == 0 && pan_y == 0)
+     {
+         return 0;
+     }
+ 
+     view->width = (frame_crop.width * ZOOM_ONE / zoom) & ~1;
+     view->height = (frame_crop.height * ZOOM_ONE / zoom) & ~1;
+     if (view->width < 2)
+     {
+         view->width = 2;
+     }
+     if (view->height < 2)
+     {
+         view->height = 2;
+     }
+ 
+     int x = (frame_width - view->width) / 2 + pan_x;
+     int y = (frame_height - view->height) / 2 + pan_y;
+     x = (x < 0) ? 0 : ((x > frame_width - view->width) ? frame_width - view->width : x);
+     y = (y < 0) ? 0 : ((y > frame_height - view->height) ? frame_height - view->height : y);
+     view->x = x & ~1;
+     view->y = y & ~1;
+     return 1;
+ }
+ 
+ /******************************************************************************
+ * Set the frame size of the streams started from now on
+ * 
+ * The size must be even and reducible to the panel within the scaler's
+ * limits (YUV_SCALE_MAX_RATIO per axis, YUV_MAX_WIDTH wide).
+ *
+ * Returns:
+ *   0 on success
+ *  -1 if the size is not supported
+ ******************************************************************************/
+ int set_stream_size(int width, int height)
+ {
+     if (width < 2 || height < 2 || (width & 1) || (height & 1) || width > YUV_MAX_WIDTH ||
+         width > OLED_WIDTH * YUV_SCALE_MAX_RATIO || height > OLED_HEIGHT * YUV_SCALE_MAX_RATIO)
+     {
+         fprintf(stderr, "Unsupported stream size %dx%d\n", width, height);
+         return -1;
+     }
+     stream_width = width;
+     stream_height = height;
+     return 0;
+ }
+ 
+ /******************************************************************************
+ * function: latch_stream_geometry
+ * brief: Fix the layout and size of the stream that is starting
+ * 
+ * Also picks the source area shown on the panel: the largest centered
+ * region with the panel's aspect ratio, so nothing is stretched. The panel
+ * is square, so the same area also fits the rotated orientations.
+ ******************************************************************************/
+ static void latch_stream_geometry(void)
+ {
+     frame_format = stream_format;
+     frame_width = stream_width;
+     frame_height = stream_height;
+ 
+     frame_crop.width = frame_width;
+     frame_crop.height = frame_height;
+     if (frame_width * OLED_HEIGHT > frame_height * OLED_WIDTH)
+     {
+         frame_crop.width = (frame_height * OLED_WIDTH / OLED_HEIGHT) & ~1;
+     }
+     else
+     {
+         frame_crop.height = (frame_width * OLED_HEIGHT / OLED_WIDTH) & ~1;
+     }
+     frame_crop.x = ((frame_width - frame_crop.width) / 2) & ~1;
+     frame_crop.y = ((frame_height - frame_crop.height) / 2) & ~1;
+ }
+ 
+ /******************************************************************************
+ * Stops video playback
+ * 
+ * This function stops the background playback thread and sets the
+ * display_active flag to 0, which signals the thread to exit.
+ * It waits for the thread to complete before returning.
+ ******************************************************************************/
+ void stop_display(void) 
+ {
+     if (display_active) 
+     {
+         display_active = 0;
+         pthread_join(display_thread, NULL);
+     }
+ }
+ 
+ /******************************************************************************
+ * Clean up OLED display resources
+ * 
+ * This function should be called before program exit to properly
+ * shut down the display, free hardware resources, and clean up
+ * any created pipes. It ensures proper termination of the display thread.
+ ******************************************************************************/
+ void oled_cleanup(void) 
+ {
+     if (display_active) 
+     {
+         stop_display();
+     }
+ 
+     // Free the global buffer if it exists
+     // if(oled_buffer != NULL) 
+     // {
+     //     free(oled_buffer);
+     //     oled_buffer = NULL;
+     // }
+ 
+     // Stop the conversion workers
+     convert_pool_stop();
+ 
+     // Send what is still queued and stop the present thread before SPI goes away
+     free_display_buffers();
+ 
+     // Clean up the panel (Waveshare driver resources) and the mirror
+     if (display_ready)
+     {
+         display->exit();
+         display_ready = 0;
+     }
+     if (mirror_ready)
+     {
+         mirror->exit();
+         mirror_ready = 0;
+     }
+ 
+     // Clean up pipe if it was created
+     if (pipe_created) 
+     {
+         unlink(PIPE_PATH);
+         pipe_created = 0;
+     }
+ }
+ 
+ 
  
\ No newline at end of file
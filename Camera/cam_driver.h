@@ -1,133 +1,445 @@
-/******************************************************************************
-* CAM_DRIVER.H
-* 
-* This header file defines the interface for controlling the OLED display
-* with camera input using the SSD1351 controller. It provides functions for:
-*   - Initializing and cleaning up the OLED display
-*   - Converting YUV420 colorspace to RGB for display
-*   - Playing back pre-recorded YUV420 video files
-*   - Displaying real-time camera feed from a named pipe
-*   - Managing display status and playback controls
-*
-* The driver is designed for a 128x128 pixel OLED display connected via SPI
-* and operates at 30 frames per second. It reads camera data in YUV420 format,
-* converts it to appropriate display format, and manages timing for smooth
-* video playback.
-*
-* Author: The One Project is Real
-* Date: 02/19/2025
-*
-* License: Version 2.1, February 1999
-*
-* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
-* <https://fsf.org/>
-* Everyone is permitted to copy and distribute verbatim copies
-* of this license document, but changing it is not allowed.
-
-* [This is the first released version of the Lesser GPL.  It also counts
-*  as the successor of the GNU Library Public License, version 2, hence
-*  the version number 2.1.]
-*
-******************************************************************************/
-#ifndef CAM_DRIVER_H
-#define CAM_DRIVER_H
-
-#include <stdint.h>             // for uint8_t (8-bit unsigned integer)
-#include <stddef.h>             // defines size_t
-
-//FPS setting (must match main's FPS)
-#define FPS 12
-
-// OLED display dimensions
-#define DISPLAY_WIDTH  128
-#define DISPLAY_HEIGHT 128
-#define PIPE_PATH "/tmp/stream_pipe"
-
-//UBYTE *oled_buffer;
-
-/******************************************************************************
- * Initialize the OLED display.
- * 
- * This function sets up the SPI interface and configures the display
- * for proper operation with the Waveshare 1.5" OLED with SSD1327 controller.
- * 
- * returns 0 on success, -1 on failure
- *******************************************************************************/
- int oled_init(void);
-
- /******************************************************************************
- * Clean up OLED display resources.
- * 
- * This function should be called before program exit to properly
- * shut down the display and free hardware resources.
- *******************************************************************************/
-void oled_cleanup(void);
-
-/******************************************************************************
- * Convert YUV420 color space to RGB. [colorspace conversion]
- * 
- * param y - Y component
- * param u - U component
- * param v - V component
- * param r Pointer to store R component
- * param g Pointer to store G component
- * param b Pointer to store B component
- *******************************************************************************/
-void yuv420_to_rgb(uint8_t y, uint8_t u, uint8_t v, uint8_t *r, uint8_t *g, uint8_t *b);
-
-/******************************************************************************
- * Start video playback on the OLED display.
- * 
- * This function starts a background thread that reads YUV420 frames
- * from the specified file and displays them on the OLED at the
- * appropriate frame rate.
- * 
- * param yuv_filename path to YUV420 video file
- * returns 0 on success, -1 on failure
- *******************************************************************************/
-int start_video_display(const char *yuv_filename);
-
-/******************************************************************************
- * Start real-time display.
- * 
- * This function sets up a background thread to read from the named pipe
- * and display frames on the OLED in real-time.
- * 
- * returns 0 on success, -1 on failure
- *******************************************************************************/
- int start_realtime_display(void);
-
-/******************************************************************************
- * Check if a YUV file is currently being displayed.
- * 
- * returns 1 if display is active, 0 if not
- *******************************************************************************/
- int is_display_active(void);
-
- //UBYTE getData(UBYTE *oled_buffer);
-
-/******************************************************************************
- * Stops video playback.
- * 
- * This function stops the background playback thread and clears
- * the display.
- *******************************************************************************/
- void stop_display(void);
-
-/******************************************************************************
- * Process and display a camera frame on OLED.
- * 
- * Takes a raw YUV420 frame from the camera, converts it to RGB565 format
- * and displays it on the connected OLED display.
- *
- * frame_data Pointer to YUV420 frame data buffer
- * data_size Size of the frame data in bytes
- * 
- * return 0 on success, negative value on error
- *******************************************************************************/
- void display_camera_frame(uint8_t *frame_date, size_t data_size);
-
- int init_display_buffers(void);
- void free_display_buffers(void);
- 
- #endif /* CAM_DRIVER_H */
+/******************************************************************************
+* CAM_DRIVER.H
+* 
+* This header file defines the interface for controlling the OLED display
+* with camera input using the SSD1351 controller. It provides functions for:
+*   - Initializing and cleaning up the OLED display
+*   - Converting YUV420 colorspace to RGB for display
+*   - Playing back pre-recorded YUV420 video files
+*   - Displaying real-time camera feed from a named pipe
+*   - Managing display status and playback controls
+*
+* The driver is designed for a 128x128 pixel OLED display connected via SPI
+* and operates at 30 frames per second. It reads camera data in YUV420 format,
+* converts it to appropriate display format, and manages timing for smooth
+* video playback.
+*
+* Author: The One Project is Real
+* Date: 02/19/2025
+*
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#ifndef CAM_DRIVER_H
+#define CAM_DRIVER_H
+
+#include <stdint.h>             // for uint8_t (8-bit unsigned integer)
+#include <stddef.h>             // defines size_t
+#include "yuv_convert.h"        // YUV420 to RGB565 conversion kernels
+#include "display_backend.h"    // panel or SSD1351 emulator
+#include "frame_sched.h"        // absolute-deadline frame pacing
+#include "frame_mailbox.h"      // newest-frame hand-off from the camera
+#include "fps_governor.h"       // adaptive frame rate
+
+// Frame-rate range of the live stream (set_fps_range). The governor
+// (fps_governor.h) starts at the top and settles on the highest rate the
+// panel's SPI clock and the CPU sustain; the capture side is told the rate
+// through set_fps_notify. File playback runs at the rate the file was
+// captured at, which the caller passes to start_video_display
+#define FPS_MIN 15
+#define FPS_MAX 30
+
+// What the frame scheduler does with a frame that starts after its
+// deadline (set_frame_late_policy). File playback skips the frames it
+// missed so the picture stays in time; live frames have nothing to skip,
+// so the timeline restarts from a late camera frame
+#define FILE_LATE_POLICY FRAME_LATE_SKIP
+#define LIVE_LATE_POLICY FRAME_LATE_SLIP
+
+// Threads converting each frame, including the display thread
+// (0 = one per online CPU)
+#define CONVERT_WORKERS 0
+
+// 1 = send the converted buffer straight to SPI in bulk (ssd1351.h),
+// 0 = go through the Waveshare OLED_1in5_rgb_Display per-byte path
+#define OLED_FUSED_SPI 1
+
+// With OLED_FUSED_SPI the frames are sent with SPI_IOC_MESSAGE ioctls on
+// this spidev node (DEV_SPI is used if it cannot be opened), at this SPI
+// clock; change it at run time with set_display_spi_clock. The SSD1351's
+// serial write cycle is 50 ns, i.e. 20 MHz by the datasheet
+#define OLED_SPIDEV "/dev/spidev0.0"
+#define OLED_SPI_HZ 20000000
+
+// Framebuffer device of display_backend_fb, for a panel run by a kernel
+// driver (fbtft or DRM ssd1351 usually register after the console's fb0)
+#define OLED_FBDEV "/dev/fb1"
+
+// Colorimetry of the camera stream. libcamera tags small video streams
+// as smpte170m (BT.601 limited range); change with set_stream_colorimetry
+#define CAMERA_COLORIMETRY YUV_BT601_LIMITED
+
+// Layout of the frames on the pipe. libcamera-vid's "--codec yuv420"
+// writes I420; NV12/NV21/YUYV sources are converted without repacking
+#define CAMERA_FORMAT YUV_FORMAT_I420
+
+// Capture resolution of the YUV stream. Frames larger than the panel are
+// center-cropped to its aspect ratio and area-downscaled during conversion,
+// so the recording keeps the full resolution
+#define CAMERA_WIDTH  640
+#define CAMERA_HEIGHT 480
+
+// Orientation of the camera picture on the panel. It is applied by the
+// conversion kernels as they write the frame, so it replaces libcamera's
+// --vflip/--hflip and can be changed with set_display_orientation while
+// the camera runs
+#define DISPLAY_ORIENTATION YUV_ORIENT_FLIP
+
+// 1 = camera streams start in interlaced mode: each frame sends only the
+// even or the odd rows, alternately (set_display_interlaced)
+#define DISPLAY_INTERLACED 0
+
+// Drive level presets of the panel (set_display_preset)
+typedef enum
+{
+    DISPLAY_PRESET_DAY = 0,     // full currents, the controller's linear gray scale
+    DISPLAY_PRESET_DUSK,        // about half brightness, gamma 1.8
+    DISPLAY_PRESET_NIGHT        // dim, reduced contrast, gamma 2.2
+} display_preset;
+
+// Digital zoom in 1/256 steps: ZOOM_ONE shows the whole (aspect-cropped)
+// frame, ZOOM_MAX an eighth of it in each direction
+#define ZOOM_ONE 256
+#define ZOOM_MAX (8 * ZOOM_ONE)
+
+// OLED display dimensions
+#define DISPLAY_WIDTH  128
+#define DISPLAY_HEIGHT 128
+#define PIPE_PATH "/tmp/stream_pipe"
+
+//UBYTE *oled_buffer;
+
+/******************************************************************************
+ * Initialize the OLED display.
+ * 
+ * This function sets up the SPI interface and configures the display
+ * for proper operation with the Waveshare 1.5" OLED with SSD1327 controller.
+ * 
+ * returns 0 on success, -1 on failure
+ *******************************************************************************/
+ int oled_init(void);
+
+ /******************************************************************************
+ * Clean up OLED display resources.
+ * 
+ * This function should be called before program exit to properly
+ * shut down the display and free hardware resources.
+ *******************************************************************************/
+void oled_cleanup(void);
+
+/******************************************************************************
+ * Start video playback on the OLED display.
+ * 
+ * This function starts a background thread that reads YUV420 frames
+ * from the specified file and displays them on the OLED at the
+ * rate the file was captured at. The governor does not change it: a
+ * different rate would change the playback speed.
+ * 
+ * param yuv_filename path to YUV420 video file
+ * param fps frame rate the file was recorded at
+ * returns 0 on success, -1 on failure
+ *******************************************************************************/
+int start_video_display(const char *yuv_filename, int fps);
+
+/******************************************************************************
+ * Start real-time display.
+ * 
+ * This function sets up a background thread to read from the named pipe
+ * and display frames on the OLED in real-time.
+ * 
+ * returns 0 on success, -1 on failure
+ *******************************************************************************/
+ int start_realtime_display(void);
+
+/******************************************************************************
+ * Check if a YUV file is currently being displayed.
+ * 
+ * returns 1 if display is active, 0 if not
+ *******************************************************************************/
+ int is_display_active(void);
+
+/******************************************************************************
+ * Get the luma statistics of the last frame put on the display.
+ *
+ * The histogram, mean, min and max are gathered by the conversion pass
+ * itself (see yuv_luma_stats), e.g. for OLED auto-brightness or exposure
+ * diagnostics. Compare 'frame' between calls to tell whether a new frame
+ * has been shown.
+ *
+ * param stats - filled with the statistics
+ * returns 0 on success, -1 if no frame has been converted yet
+ *******************************************************************************/
+ int get_display_luma_stats(yuv_luma_stats *stats);
+
+/******************************************************************************
+ * Copy the pacing statistics of the running (or last) stream.
+ *
+ * Frames are released on a fixed timeline of absolute deadlines; phase is
+ * how long after its deadline a frame was released, and its deviation is
+ * the frame-to-frame jitter.
+ *
+ * param stats - filled with the statistics
+ * returns 0 on success, -1 if no stream has been started yet
+ *******************************************************************************/
+ int get_frame_sched_stats(frame_sched_stats *stats);
+
+/******************************************************************************
+ * Copy the frame counts of the running (or last) camera stream.
+ *
+ * The display always shows the newest complete frame from the pipe; frames
+ * replaced by a newer one before the panel was free count as dropped.
+ *
+ * param stats - filled with the counts
+ * returns 0 on success, -1 if no camera stream has been started yet
+ *******************************************************************************/
+ int get_live_frame_stats(frame_mailbox_stats *stats);
+
+/******************************************************************************
+ * Called with the new rate whenever the governor changes it, and with the
+ * starting rate when a live stream starts; runs on the display thread, so
+ * it should only record the rate (e.g. for the camera's next start).
+ *******************************************************************************/
+typedef void (*fps_notify_fn)(int fps);
+
+/******************************************************************************
+ * Get the frame rate currently chosen by the governor; the camera should
+ * capture at (at least) this rate.
+ *
+ * returns frames per second
+ *******************************************************************************/
+ int get_display_fps(void);
+
+/******************************************************************************
+ * Copy the governor's rate and the conversion and transfer times it is
+ * based on.
+ *
+ * param stats - filled with the statistics
+ * returns 0 on success, -1 if no camera stream has been started yet
+ *******************************************************************************/
+ int get_fps_governor_stats(fps_governor_stats *stats);
+
+/******************************************************************************
+ * Set the range the governor keeps the live frame rate in; takes effect at
+ * once, also for a running stream.
+ *
+ * param min_fps - lowest rate, at least 1
+ * param max_fps - highest rate, at least min_fps
+ * returns 0 on success, -1 for an invalid range
+ *******************************************************************************/
+ int set_fps_range(int min_fps, int max_fps);
+
+/******************************************************************************
+ * Set the function told about frame-rate changes (NULL for none).
+ *******************************************************************************/
+ void set_fps_notify(fps_notify_fn fn);
+
+/******************************************************************************
+ * Set what the frame scheduler does with late frames in the streams
+ * started from now on.
+ *
+ * param live - nonzero for the camera pipe, 0 for file playback
+ * param policy - FRAME_LATE_SKIP, FRAME_LATE_CATCH_UP or FRAME_LATE_SLIP
+ * returns 0 on success, -1 for an unknown policy
+ *******************************************************************************/
+ int set_frame_late_policy(int live, frame_late_policy policy);
+
+/******************************************************************************
+ * Set the colorimetry of the streams started from now on.
+ *
+ * The conversion variant for the matrix and range is selected once when
+ * start_video_display or start_realtime_display starts a stream.
+ *
+ * returns 0 on success, -1 for an unknown colorimetry
+ *******************************************************************************/
+ int set_stream_colorimetry(yuv_colorimetry_t colorimetry);
+
+/******************************************************************************
+ * Set the frame layout of the streams started from now on.
+ *
+ * The pipe and file readers size their reads with yuv_frame_size for this
+ * layout and display_camera_frame converts it directly.
+ *
+ * returns 0 on success, -1 for an unknown format
+ *******************************************************************************/
+ int set_stream_format(yuv_format_t format);
+
+/******************************************************************************
+ * Set the orientation of the picture on the panel.
+ *
+ * Unlike the stream settings it applies from the next frame on, without
+ * restarting the stream or the camera.
+ *
+ * returns 0 on success, -1 for an unknown orientation
+ *******************************************************************************/
+ int set_display_orientation(yuv_orientation_t orientation);
+
+/******************************************************************************
+ * Switch the grayscale (night) mode on or off.
+ *
+ * In grayscale mode the conversion reads only the luma plane, which is
+ * cheaper and keeps low-light chroma noise off the panel. It applies from
+ * the next frame on, like the orientation.
+ *
+ * param enable - nonzero for grayscale, 0 for color
+ * returns 0
+ *******************************************************************************/
+ int set_display_grayscale(int enable);
+
+/******************************************************************************
+ * Switch the interlaced (half-field) update mode on or off.
+ *
+ * While a camera stream or file plays, each frame then sends only its even
+ * rows or only its odd rows, alternating, so a frame takes about half the
+ * SPI time and the frame-rate governor can show twice as many; the rows of
+ * the other field follow with the next frame. Frames shown while no stream
+ * runs (the HUD) always go out whole. Applies from the next frame.
+ *
+ * param enable - nonzero for interlaced, 0 for whole frames
+ * returns 0
+ *******************************************************************************/
+ int set_display_interlaced(int enable);
+
+/******************************************************************************
+ * Select where the frames go: display_backend_oled (the default),
+ * display_backend_fb for a panel behind a kernel framebuffer driver, or
+ * display_backend_emu to run the pipeline against the emulated SSD1351 on a
+ * machine without the panel.
+ *
+ * Call before oled_init, or after oled_cleanup.
+ *
+ * param backend - display backend
+ * returns 0 on success, -1 if the current backend is in use
+ *******************************************************************************/
+ int set_display_backend(const display_backend *backend);
+
+/******************************************************************************
+ * Also send every frame shown to a second backend, e.g. display_backend_shm
+ * so other processes can read what the panel shows (display_shm.h).
+ *
+ * Call before oled_init, or after oled_cleanup.
+ *
+ * param backend - mirror backend, NULL for none
+ * returns 0 on success, -1 if the current mirror is in use
+ *******************************************************************************/
+ int set_display_mirror(const display_backend *backend);
+
+/******************************************************************************
+ * Set the SPI clock of the display transfers.
+ *
+ * Applies from the next transfer on the spidev path; when the spidev node
+ * is not open yet, it is the clock it will be opened with. The emulator
+ * backend simulates its bus at this clock.
+ *
+ * param hz - SPI clock in Hz
+ * returns 0 on success, -1 for a zero clock
+ *******************************************************************************/
+ int set_display_spi_clock(uint32_t hz);
+
+/******************************************************************************
+ * Program the panel's drive levels: gray scale table (gamma), contrast
+ * currents and master current.
+ *
+ * The controller applies them as it drives the pixels, so brightness and
+ * gamma change without any per-pixel work or a new frame. They can be set
+ * at any time, also before oled_init, and are sent again whenever the
+ * panel is initialized. Needs a backend with drive levels (the panel or
+ * the emulator).
+ *
+ * param levels - gamma 0 to DISPLAY_GAMMA_MAX (0 for the controller's
+ *                linear table), master current 0 to 15
+ * returns 0 on success, -1 for NULL or invalid levels (a NaN gamma
+ *         included) or a backend without them
+ *******************************************************************************/
+ int set_display_levels(const display_levels *levels);
+
+/******************************************************************************
+ * Switch the panel to the drive levels of a preset (day, dusk or night).
+ *
+ * param preset - preset
+ * returns 0 on success, -1 on failure (see set_display_levels)
+ *******************************************************************************/
+ int set_display_preset(display_preset preset);
+
+/******************************************************************************
+ * Name of a drive level preset, for logs and the HUD.
+ *******************************************************************************/
+ const char *display_preset_name(display_preset preset);
+
+/******************************************************************************
+ * Zoom into a region of the camera picture.
+ *
+ * The region is resampled to the panel by the conversion pass itself (fixed
+ * point area weights), so there is no extra frame copy, and like the
+ * orientation it applies from the next frame on without restarting the
+ * camera. The region is kept inside the frame, so panning past an edge
+ * stops at it.
+ *
+ * param zoom - magnification in 1/256 steps, ZOOM_ONE to ZOOM_MAX
+ * param pan_x, pan_y - offset of the region's center from the frame's
+ *                      center, in source pixels
+ * returns 0 on success, -1 for a zoom outside the supported range
+ *******************************************************************************/
+ int set_display_zoom(int zoom, int pan_x, int pan_y);
+
+/******************************************************************************
+ * Set the frame size of the streams started from now on.
+ *
+ * Frames of any other size than the panel are downscaled (or enlarged) to
+ * it while they are converted.
+ *
+ * returns 0 on success, -1 if the size cannot be scaled to the panel
+ *******************************************************************************/
+ int set_stream_size(int width, int height);
+
+ //UBYTE getData(UBYTE *oled_buffer);
+
+/******************************************************************************
+ * Stops video playback.
+ * 
+ * This function stops the background playback thread and clears
+ * the display.
+ *******************************************************************************/
+ void stop_display(void);
+
+/******************************************************************************
+ * Process and display a camera frame on OLED.
+ * 
+ * Takes a raw frame from the camera in the stream's layout (I420 by
+ * default, see set_stream_format), converts it to RGB565 format and
+ * displays it on the connected OLED display. It returns once the converted
+ * frame is queued; the SPI transfer runs on the present thread, overlapping
+ * the conversion of the next frame.
+ *
+ * frame_data Pointer to frame data buffer
+ * data_size Size of the frame data in bytes
+ * 
+ * return 0 on success, negative value on error
+ *******************************************************************************/
+ void display_camera_frame(uint8_t *frame_date, size_t data_size);
+
+/******************************************************************************
+ * Show a finished RGB565 image on the OLED, e.g. a frame drawn with the
+ * Waveshare Paint functions.
+ * 
+ * Only the rectangles that differ from the previous frame are sent over
+ * SPI (column/row windows), so redrawing a HUD where a single field
+ * changed costs a fraction of a full frame. The image is copied, so the
+ * caller can start drawing the next frame right away.
+ *
+ * image - big-endian RGB565 image of DISPLAY_WIDTH x DISPLAY_HEIGHT pixels
+ *******************************************************************************/
+ void display_rgb565_frame(const uint8_t *image);
+
+ int init_display_buffers(void);
+ void free_display_buffers(void);
+ 
+ #endif /* CAM_DRIVER_H */
@@ -0,0 +1,264 @@
+/******************************************************************************
+* CONVERT_POOL.C
+*
+* Implementation of the persistent conversion worker pool. Worker threads are
+* created once and sleep on a condition variable between frames. Each frame
+* bumps a generation counter to wake them, every worker converts its band,
+* and the caller waits on a pending counter. That is the barrier before the
+* frame is handed to the display.
+*
+* Thread creation and teardown never happen per frame, so using more cores
+* only adds the cost of one wake-up per worker.
+*
+* Dependencies:
+*   - pthread.h - POSIX threads
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "convert_pool.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// Pool state, protected by 'lock'; 'run_lock' serializes jobs against
+// start/stop so the worker set never changes under a running frame
+static struct
+{
+    pthread_mutex_t lock;
+    pthread_mutex_t run_lock;
+    pthread_cond_t start_cond;
+    pthread_cond_t done_cond;
+    pthread_t threads[CONVERT_POOL_MAX_WORKERS];
+    int thread_count;           // helper threads (workers minus the caller)
+    unsigned generation;        // bumped for every job
+    unsigned start_generation;  // generation when the helpers were created
+    int pending;                // helpers still working on the current job
+    int stopping;
+
+    // Current job
+    convert_band_fn fn;
+    void *ctx;
+    int rows;
+    int bands;
+    int band_rows;
+} pool =
+{
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .run_lock = PTHREAD_MUTEX_INITIALIZER,
+    .start_cond = PTHREAD_COND_INITIALIZER,
+    .done_cond = PTHREAD_COND_INITIALIZER,
+};
+
+/******************************************************************************
+* function: run_band
+* brief: Run band 'index' of the current job, if it exists
+******************************************************************************/
+static void run_band(convert_band_fn fn, void *ctx, int rows, int band_rows, int index)
+{
+    int row_begin = index * band_rows;
+    int row_end = row_begin + band_rows;
+
+    if (row_begin >= rows)
+    {
+        return;
+    }
+    if (row_end > rows)
+    {
+        row_end = rows;
+    }
+    fn(ctx, row_begin, row_end);
+}
+
+/******************************************************************************
+* function: pool_worker
+* brief: Worker thread; converts band 'index' of every job
+******************************************************************************/
+static void *pool_worker(void *arg)
+{
+    int index = (int)(intptr_t)arg;
+
+    // Start from the generation at creation time, not the current one, so a
+    // job posted before this thread first runs is not missed
+    pthread_mutex_lock(&pool.lock);
+    unsigned seen = pool.start_generation;
+
+    for (;;)
+    {
+        while (!pool.stopping && pool.generation == seen)
+        {
+            pthread_cond_wait(&pool.start_cond, &pool.lock);
+        }
+        if (pool.stopping)
+        {
+            break;
+        }
+        seen = pool.generation;
+
+        convert_band_fn fn = pool.fn;
+        void *ctx = pool.ctx;
+        int rows = pool.rows;
+        int band_rows = pool.band_rows;
+        int bands = pool.bands;
+        pthread_mutex_unlock(&pool.lock);
+
+        if (index < bands)
+        {
+            run_band(fn, ctx, rows, band_rows, index);
+        }
+
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.pending == 0)
+        {
+            pthread_cond_signal(&pool.done_cond);
+        }
+    }
+
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+/******************************************************************************
+* function: stop_threads
+* brief: Signal all helper threads to exit and join them (run_lock held)
+******************************************************************************/
+static void stop_threads(void)
+{
+    pthread_mutex_lock(&pool.lock);
+    pool.stopping = 1;
+    pthread_cond_broadcast(&pool.start_cond);
+    pthread_mutex_unlock(&pool.lock);
+
+    for (int i = 0; i < pool.thread_count; i++)
+    {
+        pthread_join(pool.threads[i], NULL);
+    }
+
+    pool.thread_count = 0;
+    pool.stopping = 0;
+}
+
+/******************************************************************************
+* function: convert_pool_start
+* brief: Start (or restart) the worker pool
+*
+* Parameters:
+*   workers - threads converting a frame including the caller, 0 = one per CPU
+*
+* returns 0 on success, -1 if a helper thread could not be created; the
+* helpers created so far keep working
+******************************************************************************/
+int convert_pool_start(int workers)
+{
+    if (workers <= 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = (cpus > 0) ? (int)cpus : 1;
+    }
+    if (workers > CONVERT_POOL_MAX_WORKERS)
+    {
+        workers = CONVERT_POOL_MAX_WORKERS;
+    }
+
+    pthread_mutex_lock(&pool.run_lock);
+    stop_threads();
+    pool.start_generation = pool.generation;
+
+    int result = 0;
+    for (int i = 0; i < workers - 1; i++)
+    {
+        // Band 0 belongs to the caller, helpers take bands 1..workers-1
+        if (pthread_create(&pool.threads[i], NULL, pool_worker, (void *)(intptr_t)(i + 1)) != 0)
+        {
+            perror("Failed to create conversion worker");
+            result = -1;
+            break;
+        }
+        pool.thread_count++;
+    }
+
+    printf("Conversion pool: %d worker(s)\n", pool.thread_count + 1);
+    pthread_mutex_unlock(&pool.run_lock);
+    return result;
+}
+
+/******************************************************************************
+* function: convert_pool_stop
+* brief: Stop the worker pool; jobs run inline afterwards
+******************************************************************************/
+void convert_pool_stop(void)
+{
+    pthread_mutex_lock(&pool.run_lock);
+    stop_threads();
+    pthread_mutex_unlock(&pool.run_lock);
+}
+
+int convert_pool_workers(void)
+{
+    return pool.thread_count + 1;
+}
+
+/******************************************************************************
+* function: convert_pool_run
+* brief: Run a job in bands and wait for all bands to finish
+*
+* Band sizes are rounded up to an even number of rows. Small jobs use fewer
+* bands (at least CONVERT_POOL_MIN_BAND_ROWS rows each) and run inline when
+* a single band is enough.
+******************************************************************************/
+void convert_pool_run(convert_band_fn fn, void *ctx, int rows)
+{
+    pthread_mutex_lock(&pool.run_lock);
+
+    int bands = pool.thread_count + 1;
+    if (bands > rows / CONVERT_POOL_MIN_BAND_ROWS)
+    {
+        bands = rows / CONVERT_POOL_MIN_BAND_ROWS;
+    }
+
+    if (bands <= 1)
+    {
+        fn(ctx, 0, rows);
+        pthread_mutex_unlock(&pool.run_lock);
+        return;
+    }
+
+    // Band height in row pairs, so no 2x2 block is split between workers
+    int pairs = (rows + 1) / 2;
+    int band_rows = ((pairs + bands - 1) / bands) * 2;
+
+    pthread_mutex_lock(&pool.lock);
+    pool.fn = fn;
+    pool.ctx = ctx;
+    pool.rows = rows;
+    pool.bands = bands;
+    pool.band_rows = band_rows;
+    pool.pending = pool.thread_count;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.start_cond);
+    pthread_mutex_unlock(&pool.lock);
+
+    run_band(fn, ctx, rows, band_rows, 0);
+
+    // Barrier: wait for every helper before the frame is used
+    pthread_mutex_lock(&pool.lock);
+    while (pool.pending > 0)
+    {
+        pthread_cond_wait(&pool.done_cond, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    pthread_mutex_unlock(&pool.run_lock);
+}
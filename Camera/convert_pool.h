@@ -0,0 +1,78 @@
+/******************************************************************************
+* CONVERT_POOL.H
+*
+* This header file defines the persistent worker pool used to spread frame
+* conversion over the Pi's cores. It provides functions for:
+*   - Starting and stopping the pool with a configurable worker count
+*   - Running a job split into horizontal bands, one band per worker
+*
+* The calling thread always takes the first band itself, and
+* convert_pool_run only returns once every band is finished. That acts as
+* the barrier between conversion and OLED_1in5_rgb_Display. Band boundaries
+* are kept on even rows, so a 2x2 chroma block never straddles two workers.
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+*
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#ifndef CONVERT_POOL_H
+#define CONVERT_POOL_H
+
+// Upper limit on workers, including the calling thread
+#define CONVERT_POOL_MAX_WORKERS 16
+
+// Bands smaller than this are not worth waking a worker for
+#define CONVERT_POOL_MIN_BAND_ROWS 16
+
+/******************************************************************************
+ * Band job callback.
+ *
+ * param ctx - job context passed to convert_pool_run
+ * param row_begin - first row of the band (always even)
+ * param row_end - one past the last row of the band
+ *******************************************************************************/
+typedef void (*convert_band_fn)(void *ctx, int row_begin, int row_end);
+
+/******************************************************************************
+ * Start the worker pool.
+ *
+ * Restarts the pool if it is already running. Jobs run inline on the
+ * calling thread until the pool is started.
+ *
+ * param workers - total number of threads converting a frame, including
+ *                 the caller; 0 selects one per online CPU
+ * returns 0 on success, -1 on failure (the pool then runs jobs inline)
+ *******************************************************************************/
+int convert_pool_start(int workers);
+
+/******************************************************************************
+ * Stop the worker pool and join its threads.
+ *******************************************************************************/
+void convert_pool_stop(void);
+
+/******************************************************************************
+ * Get the number of threads that convert a frame, including the caller.
+ *******************************************************************************/
+int convert_pool_workers(void);
+
+/******************************************************************************
+ * Run a job split into bands of even row count and wait for all of them.
+ *
+ * param fn - band callback
+ * param ctx - context passed to every band
+ * param rows - total number of rows in the job
+ *******************************************************************************/
+void convert_pool_run(convert_band_fn fn, void *ctx, int rows);
+
+#endif /* CONVERT_POOL_H */
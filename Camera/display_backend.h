@@ -0,0 +1,96 @@
+/******************************************************************************
+* DISPLAY_BACKEND.H
+*
+* This header file defines the interface between the camera driver and the
+* device that shows its frames. It provides:
+*   - The display_backend table of init/clear/display/exit functions
+*   - The Waveshare OLED backend (display_oled.c), driving the real panel
+*   - The SSD1351 emulator backend (ssd1351_emu.c), which decodes the same
+*     command stream into an emulated GDDRAM at a simulated SPI clock
+*   - The shared-memory backend (display_shm.c), which publishes each frame
+*     to other processes
+*   - The framebuffer backend (display_fb.c), for panels driven by a kernel
+*     driver (fbtft, DRM) through /dev/fb*
+*
+* cam_driver only calls the panel through the selected backend, so the
+* whole pipeline (pipe, conversion, present thread, partial updates) can be
+* run and timed on a machine without a Pi, GPIO or panel by selecting the
+* emulator with set_display_backend before oled_init. A second backend
+* can mirror the first (set_display_mirror), e.g. the shared-memory one
+* next to the panel.
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+*
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#ifndef DISPLAY_BACKEND_H
+#define DISPLAY_BACKEND_H
+
+#include <stdint.h>             // for uint8_t (8-bit unsigned integer)
+
+// Highest gamma a backend is asked for
+#define DISPLAY_GAMMA_MAX 4.0
+
+// Drive levels of an OLED panel: applied by the controller to every pixel
+// it drives, so they cost nothing per frame
+typedef struct
+{
+    double gamma;               // gray scale response, 0 for the controller's linear table
+    uint8_t contrast[3];        // contrast current of red, green and blue
+    uint8_t master;             // master current, 0 (dimmest) to 15
+} display_levels;
+
+/******************************************************************************
+ * A display backend. init and exit run on the caller's thread; display
+ * runs on the present thread, one frame at a time. clear and
+ * set_spi_clock may be called while frames are being presented.
+ *
+ * init - bring the panel up; returns 0 on success, -1 on failure
+ * clear - blank the panel
+ * display - show a big-endian RGB565 frame of the panel's size; 'prev' is
+ *           the frame the panel shows, or NULL if unknown
+ * display_field - optional: show only the even (field 0) or odd (field 1)
+ *                 rows of a frame; 'prev' is the frame the panel shows.
+ *                 Backends without it are given whole frames in which
+ *                 the other field's rows are those of 'prev'
+ * set_spi_clock - SPI clock of the frame transfers, in Hz
+ * set_levels - optional: program the panel's drive levels; never called
+ *              while a frame is being sent
+ * exit - shut the panel down and release its resources
+ *******************************************************************************/
+typedef struct
+{
+    const char *name;
+    int (*init)(void);
+    void (*clear)(void);
+    void (*display)(const uint8_t *frame, const uint8_t *prev);
+    void (*display_field)(const uint8_t *frame, const uint8_t *prev, int field);
+    void (*set_spi_clock)(uint32_t hz);
+    void (*set_levels)(const display_levels *levels);
+    void (*exit)(void);
+} display_backend;
+
+// Waveshare 1.5" RGB OLED over DEV_Config/spidev (display_oled.c)
+extern const display_backend display_backend_oled;
+
+// Emulated SSD1351 (ssd1351_emu.c)
+extern const display_backend display_backend_emu;
+
+// POSIX shared-memory framebuffer (display_shm.c)
+extern const display_backend display_backend_shm;
+
+// Linux framebuffer device OLED_FBDEV (display_fb.c)
+extern const display_backend display_backend_fb;
+
+#endif /* DISPLAY_BACKEND_H */
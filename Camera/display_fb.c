@@ -0,0 +1,261 @@
+/******************************************************************************
+* DISPLAY_FB.C
+*
+* Display backend for a Linux framebuffer device (/dev/fb*), e.g. the
+* fbtft or DRM driver of an SSD1351, a vfb test device or a desktop's
+* framebuffer. The kernel driver does the SPI transfer (with DMA), so
+* frames only have to be written into the mapped framebuffer.
+*
+* The panel frames are big-endian RGB565; the framebuffer's layout comes
+* from its variable and fixed screen info. Native RGB565 (the usual format
+* of small panels) takes a byte swap per pixel; any other true-color format
+* of 16, 24 or 32 bits per pixel is packed from its red/green/blue
+* bitfields. Rows follow the framebuffer's line length, not its width, and
+* the frame is centered on larger screens.
+*
+* Rows that are the same as in the previous frame are not written. Drivers
+* with deferred I/O (fbtft, DRM fbdev emulation) track the pages that were
+* written and only send those, so a static HUD causes no SPI traffic.
+*
+* Dependencies:
+*   - linux/fb.h - framebuffer screen info
+*   - sys/mman.h - mapping the framebuffer
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "display_backend.h"
+#include "cam_driver.h"         // OLED_FBDEV
+#include "ssd1351.h"            // panel geometry
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/fb.h>
+
+#define SSD1351_PITCH (SSD1351_WIDTH * 2)
+
+// Mapped framebuffer and its pixel layout
+static struct
+{
+    int fd;
+    uint8_t *map;
+    size_t map_len;
+    uint8_t *origin;            // first pixel of the frame's area
+    size_t stride;              // bytes per framebuffer line
+    int bytes_per_pixel;
+    int width, height;          // part of the frame that fits on the screen
+    int rgb565;                 // native RGB565: a byte swap per pixel
+    struct fb_bitfield red, green, blue;
+    uint32_t opaque;            // alpha bits, all set
+} fb =
+{
+    .fd = -1,
+};
+
+/******************************************************************************
+* function: fb_backend_init
+* brief: Open and map the framebuffer and work out its pixel layout
+******************************************************************************/
+static int fb_backend_init(void)
+{
+    struct fb_var_screeninfo var;
+    struct fb_fix_screeninfo fix;
+
+    fb.fd = open(OLED_FBDEV, O_RDWR);
+    if (fb.fd < 0)
+    {
+        perror("Failed to open framebuffer");
+        return -1;
+    }
+    if (ioctl(fb.fd, FBIOGET_VSCREENINFO, &var) < 0 || ioctl(fb.fd, FBIOGET_FSCREENINFO, &fix) < 0)
+    {
+        perror("Failed to read framebuffer info");
+        close(fb.fd);
+        fb.fd = -1;
+        return -1;
+    }
+
+    if (fix.type != FB_TYPE_PACKED_PIXELS ||
+        (fix.visual != FB_VISUAL_TRUECOLOR && fix.visual != FB_VISUAL_DIRECTCOLOR) ||
+        (var.bits_per_pixel != 16 && var.bits_per_pixel != 24 && var.bits_per_pixel != 32) ||
+        var.red.length > 8 || var.green.length > 8 || var.blue.length > 8)
+    {
+        fprintf(stderr, "Framebuffer %s: unsupported format (%u bpp, visual %u)\n",
+                OLED_FBDEV, var.bits_per_pixel, fix.visual);
+        close(fb.fd);
+        fb.fd = -1;
+        return -1;
+    }
+
+    fb.map_len = fix.smem_len;
+    fb.map = mmap(NULL, fb.map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fb.fd, 0);
+    if (fb.map == MAP_FAILED)
+    {
+        perror("Failed to map framebuffer");
+        fb.map = NULL;
+        close(fb.fd);
+        fb.fd = -1;
+        return -1;
+    }
+
+    fb.bytes_per_pixel = var.bits_per_pixel / 8;
+    fb.stride = fix.line_length;
+    fb.red = var.red;
+    fb.green = var.green;
+    fb.blue = var.blue;
+    fb.opaque = (var.transp.length > 0 && var.transp.length < 32) ?
+                ((1u << var.transp.length) - 1) << var.transp.offset : 0;
+    fb.rgb565 = (var.bits_per_pixel == 16 &&
+                 var.red.offset == 11 && var.red.length == 5 &&
+                 var.green.offset == 5 && var.green.length == 6 &&
+                 var.blue.offset == 0 && var.blue.length == 5);
+
+    // Centered in the visible area, clipped if the screen is smaller
+    fb.width = (var.xres < SSD1351_WIDTH) ? (int)var.xres : SSD1351_WIDTH;
+    fb.height = (var.yres < SSD1351_HEIGHT) ? (int)var.yres : SSD1351_HEIGHT;
+    fb.origin = fb.map + (size_t)(var.yoffset + (var.yres - fb.height) / 2) * fb.stride
+              + (size_t)(var.xoffset + (var.xres - fb.width) / 2) * fb.bytes_per_pixel;
+
+    printf("Framebuffer %s: %ux%u, %u bpp%s, line %zu bytes\n", OLED_FBDEV,
+           var.xres, var.yres, var.bits_per_pixel, fb.rgb565 ? " RGB565" : "", fb.stride);
+    return 0;
+}
+
+/******************************************************************************
+* function: fb_pack
+* brief: Pack an RGB565 pixel into the framebuffer's bitfields
+******************************************************************************/
+static uint32_t fb_pack(uint16_t pixel)
+{
+    // Widen to 8 bits per channel, then keep the top 'length' bits
+    uint32_t r = (pixel >> 11) & 0x1F;
+    uint32_t g = (pixel >> 5) & 0x3F;
+    uint32_t b = pixel & 0x1F;
+
+    r = (r << 3) | (r >> 2);
+    g = (g << 2) | (g >> 4);
+    b = (b << 3) | (b >> 2);
+
+    return fb.opaque |
+           ((r >> (8 - fb.red.length)) << fb.red.offset) |
+           ((g >> (8 - fb.green.length)) << fb.green.offset) |
+           ((b >> (8 - fb.blue.length)) << fb.blue.offset);
+}
+
+/******************************************************************************
+* function: fb_write_row
+* brief: Write one frame row into the framebuffer in its pixel format
+******************************************************************************/
+static void fb_write_row(uint8_t *dst, const uint8_t *src)
+{
+    if (fb.rgb565)
+    {
+        uint16_t *out = (uint16_t *)dst;
+
+        for (int x = 0; x < fb.width; x++)
+        {
+            out[x] = (uint16_t)((src[2 * x] << 8) | src[2 * x + 1]);
+        }
+        return;
+    }
+
+    for (int x = 0; x < fb.width; x++)
+    {
+        uint32_t value = fb_pack((uint16_t)((src[2 * x] << 8) | src[2 * x + 1]));
+
+        switch (fb.bytes_per_pixel)
+        {
+        case 2:
+            ((uint16_t *)dst)[x] = (uint16_t)value;
+            break;
+        case 4:
+            ((uint32_t *)dst)[x] = value;
+            break;
+        default:
+            // Packed 24-bit pixels are stored least significant byte first
+            dst[3 * x] = (uint8_t)value;
+            dst[3 * x + 1] = (uint8_t)(value >> 8);
+            dst[3 * x + 2] = (uint8_t)(value >> 16);
+            break;
+        }
+    }
+}
+
+/******************************************************************************
+* function: fb_backend_display
+* brief: Write the rows that changed into the framebuffer (present thread)
+******************************************************************************/
+static void fb_backend_display(const uint8_t *frame, const uint8_t *prev)
+{
+    for (int y = 0; y < fb.height; y++)
+    {
+        const uint8_t *src = frame + y * SSD1351_PITCH;
+
+        if (prev != NULL && memcmp(src, prev + y * SSD1351_PITCH, fb.width * 2) == 0)
+        {
+            continue;
+        }
+        fb_write_row(fb.origin + y * fb.stride, src);
+    }
+}
+
+/******************************************************************************
+* function: fb_backend_clear
+* brief: Fill the panel area with black
+*
+* Goes through fb_write_row like a frame, so on formats with an alpha
+* field the pixels are opaque black rather than transparent.
+******************************************************************************/
+static void fb_backend_clear(void)
+{
+    static const uint8_t black[SSD1351_PITCH];
+
+    for (int y = 0; y < fb.height; y++)
+    {
+        fb_write_row(fb.origin + y * fb.stride, black);
+    }
+}
+
+static void fb_backend_set_spi_clock(uint32_t hz)
+{
+    // The kernel driver owns the bus; its clock comes from the device tree
+    (void)hz;
+}
+
+static void fb_backend_exit(void)
+{
+    if (fb.map != NULL)
+    {
+        munmap(fb.map, fb.map_len);
+        fb.map = NULL;
+    }
+    if (fb.fd >= 0)
+    {
+        close(fb.fd);
+        fb.fd = -1;
+    }
+}
+
+const display_backend display_backend_fb =
+{
+    .name = "fbdev",
+    .init = fb_backend_init,
+    .clear = fb_backend_clear,
+    .display = fb_backend_display,
+    .set_spi_clock = fb_backend_set_spi_clock,
+    .exit = fb_backend_exit,
+};
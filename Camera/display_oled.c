@@ -0,0 +1,144 @@
+/******************************************************************************
+* DISPLAY_OLED.C
+*
+* Display backend for the Waveshare 1.5" RGB OLED (SSD1351). Bringing the
+* panel up and clearing it use the Waveshare driver; frames go through the
+* bulk ssd1351 transfers (partial updates, spidev when available) or, with
+* OLED_FUSED_SPI off, through the Waveshare per-byte OLED_1in5_rgb_Display.
+*
+* Dependencies:
+*   - DEV_Config.h - Waveshare SPI and GPIO helpers
+*   - OLED_1in5_rgb.h - Waveshare OLED driver
+*   - ssd1351.h - bulk SSD1351 window/data transfers
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "display_backend.h"
+#include "cam_driver.h"         // OLED_FUSED_SPI, OLED_SPIDEV, OLED_SPI_HZ
+#include "DEV_Config.h"
+#include "OLED_1in5_rgb.h"
+#include "ssd1351.h"
+#include <stdio.h>
+
+static volatile uint32_t spi_clock_hz = OLED_SPI_HZ;
+
+/******************************************************************************
+* function: oled_backend_init
+* brief: Initialize the GPIO/SPI layer and the panel
+*
+* The spidev node is opened after the Waveshare init sequence, which goes
+* through DEV_SPI; if it cannot be opened the frames use DEV_SPI as well.
+******************************************************************************/
+static int oled_backend_init(void)
+{
+    if (DEV_ModuleInit() != 0)
+    {
+        printf("DEV_ModuleInit failed\n");
+        return -1;
+    }
+
+    OLED_1in5_rgb_Init();
+    DEV_Delay_ms(100);
+
+#if OLED_FUSED_SPI
+    if (ssd1351_spi_open(OLED_SPIDEV, spi_clock_hz) == 0)
+    {
+        printf("OLED SPI: %s at %u Hz\n", OLED_SPIDEV, (unsigned)spi_clock_hz);
+    }
+    else
+    {
+        printf("OLED SPI: %s not available, using DEV_SPI\n", OLED_SPIDEV);
+    }
+#endif
+    return 0;
+}
+
+static void oled_backend_clear(void)
+{
+    OLED_1in5_rgb_Clear();
+}
+
+/******************************************************************************
+* function: oled_backend_display
+* brief: Send a frame to the panel (present thread)
+******************************************************************************/
+static void oled_backend_display(const uint8_t *frame, const uint8_t *prev)
+{
+#if OLED_FUSED_SPI
+    // The buffer the kernels wrote is already in panel byte order, so the
+    // changed rectangles are handed to the SPI transfer as-is
+    ssd1351_write_changes(frame, prev);
+#else
+    // The Waveshare driver only reads the image
+    (void)prev;
+    OLED_1in5_rgb_Display((UBYTE *)frame);
+#endif
+}
+
+#if OLED_FUSED_SPI
+/******************************************************************************
+* function: oled_backend_display_field
+* brief: Send the rows of one field to the panel (present thread)
+******************************************************************************/
+static void oled_backend_display_field(const uint8_t *frame, const uint8_t *prev, int field)
+{
+    ssd1351_write_field(frame, prev, field);
+}
+#endif
+
+static void oled_backend_set_spi_clock(uint32_t hz)
+{
+    // Also the clock the spidev node is opened with by the next init
+    spi_clock_hz = hz;
+    ssd1351_spi_set_speed(hz);
+}
+
+/******************************************************************************
+* function: oled_backend_set_levels
+* brief: Program the gray scale table, contrast and master current
+*
+* The Waveshare init sequence leaves the restricted commands unlocked, so
+* the contrast command is accepted.
+******************************************************************************/
+static void oled_backend_set_levels(const display_levels *levels)
+{
+    uint8_t table[SSD1351_GRAY_LEVELS];
+
+    if (levels->gamma > 0.0)
+    {
+        ssd1351_gamma_table(levels->gamma, table);
+    }
+    ssd1351_set_levels((levels->gamma > 0.0) ? table : NULL, levels->contrast, levels->master);
+}
+
+static void oled_backend_exit(void)
+{
+    ssd1351_spi_close();
+    DEV_ModuleExit();
+}
+
+const display_backend display_backend_oled =
+{
+    .name = "oled",
+    .init = oled_backend_init,
+    .clear = oled_backend_clear,
+    .display = oled_backend_display,
+#if OLED_FUSED_SPI
+    .display_field = oled_backend_display_field,
+#endif
+    .set_spi_clock = oled_backend_set_spi_clock,
+    .set_levels = oled_backend_set_levels,
+    .exit = oled_backend_exit,
+};
@@ -0,0 +1,278 @@
+/******************************************************************************
+* DISPLAY_SHM.C
+*
+* Shared-memory framebuffer backend and its reader side. The segment is
+* created by the backend's init with shm_open and unlinked by its exit, like
+* the camera pipe; readers that still have it mapped keep the last frame.
+*
+* The seqlock uses the GCC __atomic builtins: the writer orders the odd
+* sequence number before the frame and the frame before the even one, and
+* the reader orders its copy between its two loads of the sequence number.
+*
+* Dependencies:
+*   - sys/mman.h - POSIX shared memory (link with -lrt on older glibc)
+*   - ssd1351.h - panel geometry
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "display_shm.h"
+#include "display_backend.h"
+#include "ssd1351.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Frame data starts on a cache line of its own
+#define SHM_DATA_OFFSET 64
+#define SHM_SIZE        (SHM_DATA_OFFSET + SSD1351_FRAME_BYTES)
+
+// Reader retries: spin this many times while the writer is in the frame,
+// then sleep SHM_READ_NAP_NS between tries, and give up after
+// DISPLAY_SHM_STUCK_MS
+#define SHM_READ_SPINS  64
+#define SHM_READ_NAP_NS 100000
+
+// Writer side, owned by the backend
+static display_shm_header *segment = NULL;
+
+/******************************************************************************
+* function: shm_backend_init
+* brief: Create the segment and fill in its header
+******************************************************************************/
+static int shm_backend_init(void)
+{
+    if (segment != NULL)
+    {
+        return 0;
+    }
+
+    int fd = shm_open(DISPLAY_SHM_NAME, O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        perror("Failed to create shared framebuffer");
+        return -1;
+    }
+    if (ftruncate(fd, SHM_SIZE) != 0)
+    {
+        perror("Failed to size shared framebuffer");
+        close(fd);
+        shm_unlink(DISPLAY_SHM_NAME);
+        return -1;
+    }
+
+    void *map = mmap(NULL, SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror("Failed to map shared framebuffer");
+        shm_unlink(DISPLAY_SHM_NAME);
+        return -1;
+    }
+
+    // A reader seeing the magic finds the rest of the header filled in
+    segment = map;
+    memset(segment, 0, SHM_SIZE);
+    segment->version = DISPLAY_SHM_VERSION;
+    segment->width = SSD1351_WIDTH;
+    segment->height = SSD1351_HEIGHT;
+    segment->stride = SSD1351_WIDTH * 2;
+    segment->format = DISPLAY_SHM_RGB565_BE;
+    segment->data_offset = SHM_DATA_OFFSET;
+    __atomic_store_n(&segment->magic, DISPLAY_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    printf("Shared framebuffer: %s\n", DISPLAY_SHM_NAME);
+    return 0;
+}
+
+/******************************************************************************
+* function: shm_publish
+* brief: Write a frame into the segment under the seqlock
+******************************************************************************/
+static void shm_publish(const uint8_t *frame)
+{
+    struct timespec now;
+    uint32_t seq = segment->seq;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    __atomic_store_n(&segment->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy((uint8_t *)segment + SHM_DATA_OFFSET, frame, SSD1351_FRAME_BYTES);
+    segment->frame++;
+    segment->timestamp_ns = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+
+    __atomic_store_n(&segment->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+static void shm_backend_clear(void)
+{
+    static const uint8_t black[SSD1351_FRAME_BYTES];
+
+    shm_publish(black);
+}
+
+static void shm_backend_display(const uint8_t *frame, const uint8_t *prev)
+{
+    // Readers always get whole frames, so there is nothing to diff
+    (void)prev;
+    shm_publish(frame);
+}
+
+static void shm_backend_set_spi_clock(uint32_t hz)
+{
+    (void)hz;
+}
+
+static void shm_backend_exit(void)
+{
+    if (segment != NULL)
+    {
+        munmap(segment, SHM_SIZE);
+        segment = NULL;
+        shm_unlink(DISPLAY_SHM_NAME);
+    }
+}
+
+const display_backend display_backend_shm =
+{
+    .name = "shm",
+    .init = shm_backend_init,
+    .clear = shm_backend_clear,
+    .display = shm_backend_display,
+    .set_spi_clock = shm_backend_set_spi_clock,
+    .exit = shm_backend_exit,
+};
+
+/******************************************************************************
+* function: display_shm_attach
+* brief: Map an existing segment read-only and check its header
+******************************************************************************/
+const display_shm_header *display_shm_attach(const char *name)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        perror("Failed to open shared framebuffer");
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(display_shm_header))
+    {
+        fprintf(stderr, "Shared framebuffer %s is not set up\n", name);
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror("Failed to map shared framebuffer");
+        return NULL;
+    }
+
+    const display_shm_header *shm = map;
+    if (__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != DISPLAY_SHM_MAGIC ||
+        shm->version != DISPLAY_SHM_VERSION ||
+        (off_t)shm->data_offset + (off_t)shm->height * shm->stride > st.st_size)
+    {
+        fprintf(stderr, "Shared framebuffer %s has an unknown layout\n", name);
+        munmap(map, st.st_size);
+        return NULL;
+    }
+    return shm;
+}
+
+void display_shm_detach(const display_shm_header *shm)
+{
+    munmap((void *)shm, shm->data_offset + (size_t)shm->height * shm->stride);
+}
+
+/******************************************************************************
+* function: display_shm_read
+* brief: Copy the published frame, retrying while the writer is in it
+*
+* Publishing a frame takes microseconds, so the first retries spin; after
+* that the reader naps between tries and, once DISPLAY_SHM_STUCK_MS have
+* passed, gives up: a writer killed in the middle of a frame leaves the
+* sequence number odd for good, and the reader must not pin a core
+* waiting for it.
+******************************************************************************/
+int display_shm_read(const display_shm_header *shm, uint8_t *frame,
+                     uint64_t *counter, uint64_t *timestamp_ns)
+{
+    const uint8_t *data = (const uint8_t *)shm + shm->data_offset;
+    size_t bytes = (size_t)shm->height * shm->stride;
+    uint64_t number, stamp;
+    uint32_t seq;
+    struct timespec start = { 0, 0 };
+
+    for (int tries = 0; ; tries++)
+    {
+        if (tries >= SHM_READ_SPINS)
+        {
+            struct timespec now;
+
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if (tries == SHM_READ_SPINS)
+            {
+                start = now;
+            }
+            else if ((now.tv_sec - start.tv_sec) * 1000 +
+                     (now.tv_nsec - start.tv_nsec) / 1000000 >= DISPLAY_SHM_STUCK_MS)
+            {
+                return -2;
+            }
+            const struct timespec nap = { 0, SHM_READ_NAP_NS };
+            nanosleep(&nap, NULL);
+        }
+
+        seq = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1)
+        {
+            continue;
+        }
+
+        memcpy(frame, data, bytes);
+        number = shm->frame;
+        stamp = shm->timestamp_ns;
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&shm->seq, __ATOMIC_RELAXED) == seq)
+        {
+            break;
+        }
+    }
+
+    if (number == 0)
+    {
+        return -1;
+    }
+    if (counter != NULL)
+    {
+        *counter = number;
+    }
+    if (timestamp_ns != NULL)
+    {
+        *timestamp_ns = stamp;
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+/******************************************************************************
+* DISPLAY_SHM.H
+*
+* This header file defines the shared-memory framebuffer that mirrors the
+* panel for other local processes (recorders, debug viewers, test
+* harnesses). It provides:
+*   - The segment layout: a header with a seqlock and frame counter,
+*     followed by one big-endian RGB565 frame
+*   - display_backend_shm (display_backend.h), which publishes every frame
+*   - Functions for readers to attach to the segment and copy a frame
+*
+* The writer never waits for readers: it makes the sequence number odd,
+* copies the frame and makes it even again. A reader copies the frame and
+* keeps it only if the sequence number was even and unchanged around the
+* copy, retrying otherwise, so publishing costs one 32 KB memcpy on the
+* present thread and no reader can slow the panel down.
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+*
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#ifndef DISPLAY_SHM_H
+#define DISPLAY_SHM_H
+
+#include <stdint.h>             // for uint8_t (8-bit unsigned integer)
+
+// Name of the POSIX shared-memory segment (shm_open)
+#define DISPLAY_SHM_NAME    "/oled_frame"
+
+// How long display_shm_read waits for a writer that is inside a frame
+#define DISPLAY_SHM_STUCK_MS 100
+
+// Header identification; a reader checks both before using the layout
+#define DISPLAY_SHM_MAGIC   0x4F4C4544      // "OLED"
+#define DISPLAY_SHM_VERSION 1
+
+// Pixel formats
+#define DISPLAY_SHM_RGB565_BE 1             // 2 bytes per pixel, high byte first
+
+// Segment header; the frame follows at 'data_offset'
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;            // bytes per row
+    uint32_t format;
+    uint32_t data_offset;       // from the start of the segment
+    uint32_t seq;               // seqlock: odd while a frame is being written
+    uint64_t frame;             // frames published, 0 = none yet
+    uint64_t timestamp_ns;      // CLOCK_MONOTONIC time of the last frame
+} display_shm_header;
+
+/******************************************************************************
+ * Map an existing segment for reading.
+ *
+ * param name - segment name, e.g. DISPLAY_SHM_NAME
+ * returns the header, or NULL if there is no valid segment
+ *******************************************************************************/
+const display_shm_header *display_shm_attach(const char *name);
+
+/******************************************************************************
+ * Unmap a segment mapped with display_shm_attach.
+ *******************************************************************************/
+void display_shm_detach(const display_shm_header *shm);
+
+/******************************************************************************
+ * Copy the frame currently published, consistently.
+ *
+ * param shm - attached segment
+ * param frame - receives height * stride bytes
+ * param counter - receives the frame's number, may be NULL
+ * param timestamp_ns - receives the frame's publish time, may be NULL
+ * returns 0 on success, -1 if no frame has been published yet, -2 if no
+ *         consistent frame could be read within DISPLAY_SHM_STUCK_MS
+ *         (the writer died while publishing; attach again once it is back)
+ *******************************************************************************/
+int display_shm_read(const display_shm_header *shm, uint8_t *frame,
+                     uint64_t *counter, uint64_t *timestamp_ns);
+
+#endif /* DISPLAY_SHM_H */
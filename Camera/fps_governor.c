@@ -0,0 +1,140 @@
+/******************************************************************************
+* FPS_GOVERNOR.C
+*
+* Implementation of the frame-rate governor. Stage costs are exponential
+* moving averages weighted 1/FPS_GOVERNOR_SMOOTHING per frame, so a single
+* slow frame (a page fault, a busy core) moves them a little and a lasting
+* change in SPI clock or CPU load moves them within a couple of windows.
+* Until a stage has a few samples, its first ones are simply averaged.
+*
+* Dependencies:
+*   - pthread.h - guards the averages, which the present thread also updates
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "fps_governor.h"
+
+#define NS_PER_SEC 1000000000.0
+
+// Weight of the history in the moving averages
+#define FPS_GOVERNOR_SMOOTHING 8
+
+static int clamp_fps(const fps_governor_stats *s, int fps)
+{
+    if (fps < s->min_fps)
+    {
+        return s->min_fps;
+    }
+    if (fps > s->max_fps)
+    {
+        return s->max_fps;
+    }
+    return fps;
+}
+
+/******************************************************************************
+* function: average_in
+* brief: Fold a sample into a stage's moving average (lock held)
+******************************************************************************/
+static void average_in(double *average, int *samples, uint64_t ns)
+{
+    int weight = (*samples < FPS_GOVERNOR_SMOOTHING) ? *samples + 1 : FPS_GOVERNOR_SMOOTHING;
+
+    *average += ((double)ns - *average) / weight;
+    if (*samples < FPS_GOVERNOR_SMOOTHING)
+    {
+        (*samples)++;
+    }
+}
+
+/******************************************************************************
+* function: fps_governor_reset
+* brief: Set the range and starting rate, forgetting the measured costs
+******************************************************************************/
+void fps_governor_reset(fps_governor *gov, int min_fps, int max_fps, int fps)
+{
+    pthread_mutex_lock(&gov->lock);
+    gov->stats.min_fps = min_fps;
+    gov->stats.max_fps = max_fps;
+    gov->stats.fps = clamp_fps(&gov->stats, fps);
+    gov->stats.convert_ns = 0.0;
+    gov->stats.present_ns = 0.0;
+    gov->stats.changes = 0;
+    gov->convert_samples = 0;
+    gov->present_samples = 0;
+    gov->frames = 0;
+    pthread_mutex_unlock(&gov->lock);
+}
+
+void fps_governor_add_convert(fps_governor *gov, uint64_t ns)
+{
+    pthread_mutex_lock(&gov->lock);
+    average_in(&gov->stats.convert_ns, &gov->convert_samples, ns);
+    pthread_mutex_unlock(&gov->lock);
+}
+
+void fps_governor_add_present(fps_governor *gov, uint64_t ns)
+{
+    pthread_mutex_lock(&gov->lock);
+    average_in(&gov->stats.present_ns, &gov->present_samples, ns);
+    pthread_mutex_unlock(&gov->lock);
+}
+
+/******************************************************************************
+* function: fps_governor_update
+* brief: Count a frame; once per window, move the rate to what the slower
+*        stage sustains
+******************************************************************************/
+int fps_governor_update(fps_governor *gov)
+{
+    pthread_mutex_lock(&gov->lock);
+    fps_governor_stats *s = &gov->stats;
+    int fps = s->fps;
+
+    if (++gov->frames >= FPS_GOVERNOR_WINDOW && gov->convert_samples > 0 && gov->present_samples > 0)
+    {
+        double cost = (s->convert_ns > s->present_ns) ? s->convert_ns : s->present_ns;
+        gov->frames = 0;
+
+        if (cost * fps > NS_PER_SEC * FPS_GOVERNOR_LOAD_HIGH / 100)
+        {
+            // Straight down to a rate the slower stage keeps up with
+            fps = clamp_fps(s, (int)(NS_PER_SEC * FPS_GOVERNOR_LOAD_HIGH / 100 / cost));
+        }
+        else if (cost * (fps + 1) < NS_PER_SEC * FPS_GOVERNOR_LOAD_LOW / 100)
+        {
+            // Half way up to the rate at the low load, so a measurement that
+            // was too good is caught before the rate overshoots much
+            int room = (int)(NS_PER_SEC * FPS_GOVERNOR_LOAD_LOW / 100 / cost) - fps;
+            fps = clamp_fps(s, fps + ((room > 1) ? room / 2 : 1));
+        }
+
+        if (fps != s->fps)
+        {
+            s->fps = fps;
+            s->changes++;
+        }
+    }
+
+    pthread_mutex_unlock(&gov->lock);
+    return fps;
+}
+
+void fps_governor_get_stats(fps_governor *gov, fps_governor_stats *stats)
+{
+    pthread_mutex_lock(&gov->lock);
+    *stats = gov->stats;
+    pthread_mutex_unlock(&gov->lock);
+}
@@ -0,0 +1,106 @@
+/******************************************************************************
+* FPS_GOVERNOR.H
+*
+* This header file defines the frame-rate governor of the live stream. It
+* provides functions for:
+*   - Recording how long each frame's conversion and presentation take
+*   - Choosing the highest frame rate within a configured range that the
+*     pipeline sustains
+*   - Reading the chosen rate and the measured stage costs
+*
+* Conversion and presentation overlap (present_queue.h), so the rate is
+* bounded by the slower of the two stages, not by their sum. Both costs are
+* averaged over the recent frames; once per window the governor compares
+* the slower one to the frame period. Above FPS_GOVERNOR_LOAD_HIGH percent
+* it drops at once to a rate the stage sustains; while the next rate up
+* would still leave it below FPS_GOVERNOR_LOAD_LOW percent, the rate climbs
+* half way to the one at that load in each window. The gap between the two
+* thresholds keeps the rate from hunting on noisy measurements.
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+*
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#ifndef FPS_GOVERNOR_H
+#define FPS_GOVERNOR_H
+
+#include <stdint.h>             // for uint64_t
+#include <pthread.h>
+
+// Frames between two decisions
+#define FPS_GOVERNOR_WINDOW 15
+
+// Share of the frame period (percent) the slower stage may take: above
+// HIGH the rate goes down, below LOW at the next rate it goes up
+#define FPS_GOVERNOR_LOAD_HIGH 90
+#define FPS_GOVERNOR_LOAD_LOW  75
+
+// Chosen rate and what it is based on
+typedef struct
+{
+    int fps;                    // current target rate
+    int min_fps;
+    int max_fps;
+    double convert_ns;          // average conversion time per frame
+    double present_ns;          // average panel transfer time per frame
+    uint64_t changes;           // rate changes since fps_governor_reset
+} fps_governor_stats;
+
+// Governor state; costs are recorded and statistics read from any thread
+typedef struct
+{
+    pthread_mutex_t lock;
+    fps_governor_stats stats;
+    int convert_samples;
+    int present_samples;
+    int frames;                 // since the last decision
+} fps_governor;
+
+// Static initializer; starts at the top of the range
+#define FPS_GOVERNOR_INITIALIZER(min, max) { .lock = PTHREAD_MUTEX_INITIALIZER, \
+        .stats = { .fps = (max), .min_fps = (min), .max_fps = (max) } }
+
+/******************************************************************************
+ * Set the range, forget the measured costs and start from a rate.
+ *
+ * param gov - governor
+ * param min_fps, max_fps - range of the rate
+ * param fps - starting rate, clamped to the range
+ *******************************************************************************/
+void fps_governor_reset(fps_governor *gov, int min_fps, int max_fps, int fps);
+
+/******************************************************************************
+ * Record the time one frame's conversion took.
+ *******************************************************************************/
+void fps_governor_add_convert(fps_governor *gov, uint64_t ns);
+
+/******************************************************************************
+ * Record the time one frame's transfer to the panel took.
+ *******************************************************************************/
+void fps_governor_add_present(fps_governor *gov, uint64_t ns);
+
+/******************************************************************************
+ * Count a frame shown and, once per window, pick the rate again.
+ *
+ * param gov - governor
+ * returns the rate for the following frames
+ *******************************************************************************/
+int fps_governor_update(fps_governor *gov);
+
+/******************************************************************************
+ * Copy the chosen rate and the measured costs.
+ *******************************************************************************/
+void fps_governor_get_stats(fps_governor *gov, fps_governor_stats *stats);
+
+#endif /* FPS_GOVERNOR_H */
@@ -0,0 +1,149 @@
+/******************************************************************************
+* FRAME_MAILBOX.C
+*
+* Implementation of the latest-frame-wins mailbox. The three buffers never
+* move; publishing and taking only swap the indices of the filling, ready
+* and reading slots under the lock, so no frame is ever copied and each
+* side owns its buffer outright between calls.
+*
+* Dependencies:
+*   - pthread.h - POSIX threads
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "frame_mailbox.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/******************************************************************************
+* function: frame_mailbox_open
+* brief: Allocate the frame buffers and clear the statistics
+*
+* Parameters:
+*   mailbox - mailbox set up with FRAME_MAILBOX_INITIALIZER
+*   frame_bytes - size of one frame
+*
+* returns 0 on success, -1 on failure
+******************************************************************************/
+int frame_mailbox_open(frame_mailbox *mailbox, size_t frame_bytes)
+{
+    uint8_t *buffers[FRAME_MAILBOX_BUFFERS];
+
+    for (int i = 0; i < FRAME_MAILBOX_BUFFERS; i++)
+    {
+        buffers[i] = malloc(frame_bytes);
+        if (buffers[i] == NULL)
+        {
+            perror("Failed to allocate mailbox frame");
+            while (i-- > 0)
+            {
+                free(buffers[i]);
+            }
+            return -1;
+        }
+    }
+
+    pthread_mutex_lock(&mailbox->lock);
+    memcpy(mailbox->buffers, buffers, sizeof(buffers));
+    mailbox->filling = 0;
+    mailbox->ready = 1;
+    mailbox->reading = 2;
+    mailbox->fresh = 0;
+    mailbox->closed = 0;
+    memset(&mailbox->stats, 0, sizeof(mailbox->stats));
+    pthread_mutex_unlock(&mailbox->lock);
+    return 0;
+}
+
+void frame_mailbox_free(frame_mailbox *mailbox)
+{
+    pthread_mutex_lock(&mailbox->lock);
+    for (int i = 0; i < FRAME_MAILBOX_BUFFERS; i++)
+    {
+        free(mailbox->buffers[i]);
+        mailbox->buffers[i] = NULL;
+    }
+    pthread_mutex_unlock(&mailbox->lock);
+}
+
+uint8_t *frame_mailbox_buffer(frame_mailbox *mailbox)
+{
+    // Only the ingest side moves 'filling', so no lock is needed to read it
+    return mailbox->buffers[mailbox->filling];
+}
+
+/******************************************************************************
+* function: frame_mailbox_publish
+* brief: Swap the filled buffer into the ready slot, dropping an untaken frame
+******************************************************************************/
+void frame_mailbox_publish(frame_mailbox *mailbox)
+{
+    pthread_mutex_lock(&mailbox->lock);
+
+    int filled = mailbox->filling;
+    mailbox->filling = mailbox->ready;
+    mailbox->ready = filled;
+
+    mailbox->stats.published++;
+    mailbox->stats.dropped += mailbox->fresh;
+    mailbox->fresh = 1;
+
+    pthread_cond_signal(&mailbox->changed);
+    pthread_mutex_unlock(&mailbox->lock);
+}
+
+/******************************************************************************
+* function: frame_mailbox_take
+* brief: Swap the newest frame into the reading slot, waiting for one
+******************************************************************************/
+const uint8_t *frame_mailbox_take(frame_mailbox *mailbox)
+{
+    const uint8_t *frame = NULL;
+
+    pthread_mutex_lock(&mailbox->lock);
+    while (!mailbox->fresh && !mailbox->closed)
+    {
+        pthread_cond_wait(&mailbox->changed, &mailbox->lock);
+    }
+
+    if (mailbox->fresh)
+    {
+        int newest = mailbox->ready;
+        mailbox->ready = mailbox->reading;
+        mailbox->reading = newest;
+        mailbox->fresh = 0;
+        mailbox->stats.taken++;
+        frame = mailbox->buffers[newest];
+    }
+
+    pthread_mutex_unlock(&mailbox->lock);
+    return frame;
+}
+
+void frame_mailbox_close(frame_mailbox *mailbox)
+{
+    pthread_mutex_lock(&mailbox->lock);
+    mailbox->closed = 1;
+    pthread_cond_broadcast(&mailbox->changed);
+    pthread_mutex_unlock(&mailbox->lock);
+}
+
+void frame_mailbox_get_stats(frame_mailbox *mailbox, frame_mailbox_stats *stats)
+{
+    pthread_mutex_lock(&mailbox->lock);
+    *stats = mailbox->stats;
+    pthread_mutex_unlock(&mailbox->lock);
+}
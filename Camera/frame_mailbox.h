@@ -0,0 +1,120 @@
+/******************************************************************************
+* FRAME_MAILBOX.H
+*
+* This header file defines the latest-frame-wins mailbox between the camera
+* ingest and the display. It provides functions for:
+*   - Filling frames on the ingest side without ever waiting for the display
+*   - Taking the newest complete frame on the display side
+*   - Counting the frames that were replaced before the display took them
+*
+* The mailbox holds three frame buffers: one being filled, one ready and one
+* being displayed. Publishing a frame swaps the filled buffer with the ready
+* one; if the ready frame had not been taken yet it is dropped. The display
+* therefore always gets the newest frame the camera has delivered, and when
+* the panel is slower than the camera the frames that cannot be shown are
+* dropped here instead of piling up in the pipe, where they would add to the
+* glass-to-glass latency.
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+*
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#ifndef FRAME_MAILBOX_H
+#define FRAME_MAILBOX_H
+
+#include <stdint.h>             // for uint8_t (8-bit unsigned integer)
+#include <stddef.h>             // defines size_t
+#include <pthread.h>
+
+// Frame buffers: being filled, ready, being displayed
+#define FRAME_MAILBOX_BUFFERS 3
+
+// Counts since frame_mailbox_open
+typedef struct
+{
+    uint64_t published;         // complete frames from the ingest side
+    uint64_t taken;             // frames handed to the display
+    uint64_t dropped;           // frames replaced by a newer one before they were taken
+} frame_mailbox_stats;
+
+// Mailbox state; the statistics may be read from any thread
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    uint8_t *buffers[FRAME_MAILBOX_BUFFERS];
+    int filling;                // index of the buffer the ingest side writes
+    int ready;                  // index of the newest complete frame
+    int reading;                // index of the frame the display holds
+    int fresh;                  // 'ready' has not been taken yet
+    int closed;
+    frame_mailbox_stats stats;
+} frame_mailbox;
+
+// Static initializer; a mailbox's statistics can be read before it opens
+#define FRAME_MAILBOX_INITIALIZER { .lock = PTHREAD_MUTEX_INITIALIZER, \
+                                    .changed = PTHREAD_COND_INITIALIZER }
+
+/******************************************************************************
+ * Allocate the frame buffers and clear the statistics. The mailbox must
+ * have been set up with FRAME_MAILBOX_INITIALIZER.
+ *
+ * param mailbox - mailbox
+ * param frame_bytes - size of one frame
+ * returns 0 on success, -1 on failure
+ *******************************************************************************/
+int frame_mailbox_open(frame_mailbox *mailbox, size_t frame_bytes);
+
+/******************************************************************************
+ * Free the frame buffers. Neither side may use the mailbox any more; the
+ * statistics stay readable.
+ *******************************************************************************/
+void frame_mailbox_free(frame_mailbox *mailbox);
+
+/******************************************************************************
+ * Buffer for the ingest side to fill with the next frame. It stays the
+ * same until frame_mailbox_publish, so a partly read frame is never seen
+ * by the display.
+ *******************************************************************************/
+uint8_t *frame_mailbox_buffer(frame_mailbox *mailbox);
+
+/******************************************************************************
+ * Make the filled buffer the newest frame. Never waits; a ready frame that
+ * was not taken yet is dropped.
+ *******************************************************************************/
+void frame_mailbox_publish(frame_mailbox *mailbox);
+
+/******************************************************************************
+ * Take the newest frame, waiting until one arrives that was not taken yet.
+ *
+ * The frame stays valid until the next call; the ingest side never writes
+ * into it.
+ *
+ * param mailbox - mailbox
+ * returns the frame, or NULL once the mailbox is closed and every frame
+ *         published has been taken or dropped
+ *******************************************************************************/
+const uint8_t *frame_mailbox_take(frame_mailbox *mailbox);
+
+/******************************************************************************
+ * Close the mailbox: frame_mailbox_take stops waiting for new frames.
+ *******************************************************************************/
+void frame_mailbox_close(frame_mailbox *mailbox);
+
+/******************************************************************************
+ * Copy the statistics.
+ *******************************************************************************/
+void frame_mailbox_get_stats(frame_mailbox *mailbox, frame_mailbox_stats *stats);
+
+#endif /* FRAME_MAILBOX_H */
@@ -0,0 +1,181 @@
+/******************************************************************************
+* FRAME_SCHED.C
+*
+* Implementation of the absolute-deadline frame scheduler. Times are kept as
+* nanoseconds on CLOCK_MONOTONIC; a deadline advances by exactly one period
+* per released frame, unless the late-frame policy moves it.
+*
+* A frame counts as late once its whole period has passed: a wake-up a few
+* microseconds after the deadline is ordinary scheduler latency and only
+* shows in the phase statistics.
+*
+* Dependencies:
+*   - time.h - clock_gettime, clock_nanosleep
+*   - pthread.h - guards the statistics
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "frame_sched.h"
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#define NS_PER_SEC 1000000000ULL
+
+static uint64_t now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * NS_PER_SEC + t.tv_nsec;
+}
+
+/******************************************************************************
+* function: sleep_until
+* brief: Sleep until an absolute CLOCK_MONOTONIC time
+******************************************************************************/
+static void sleep_until(uint64_t deadline_ns)
+{
+    struct timespec t =
+    {
+        .tv_sec = deadline_ns / NS_PER_SEC,
+        .tv_nsec = deadline_ns % NS_PER_SEC,
+    };
+
+    // An absolute deadline survives signals: just sleep again
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR)
+    {
+    }
+}
+
+/******************************************************************************
+* function: frame_sched_start
+* brief: Start a timeline whose first deadline is now
+******************************************************************************/
+void frame_sched_start(frame_sched *sched, int fps, frame_late_policy policy)
+{
+    sched->period_ns = NS_PER_SEC / (fps > 0 ? fps : 1);
+    sched->deadline_ns = now_ns();
+    sched->policy = policy;
+
+    pthread_mutex_lock(&sched->lock);
+    memset(&sched->stats, 0, sizeof(sched->stats));
+    sched->phase_sum = 0.0;
+    sched->phase_sum_sq = 0.0;
+    pthread_mutex_unlock(&sched->lock);
+}
+
+/******************************************************************************
+* function: frame_sched_set_rate
+* brief: Change the period from the next deadline on
+******************************************************************************/
+void frame_sched_set_rate(frame_sched *sched, int fps)
+{
+    uint64_t period_ns = NS_PER_SEC / (fps > 0 ? fps : 1);
+
+    // deadline_ns is already one old period past the last frame's deadline
+    sched->deadline_ns = sched->deadline_ns - sched->period_ns + period_ns;
+    sched->period_ns = period_ns;
+}
+
+/******************************************************************************
+* function: frame_sched_wait
+* brief: Wait for the next frame's deadline, applying the late-frame policy
+*
+* returns the number of periods dropped
+******************************************************************************/
+int frame_sched_wait(frame_sched *sched)
+{
+    uint64_t now = now_ns();
+    uint64_t behind = (now > sched->deadline_ns) ? (now - sched->deadline_ns) / sched->period_ns : 0;
+    uint64_t dropped = 0;
+    int slipped = 0;
+
+    if (behind == 0)
+    {
+        sleep_until(sched->deadline_ns);
+        now = now_ns();
+    }
+    else if (sched->policy == FRAME_LATE_SKIP)
+    {
+        // The current period is the one 'now' falls into
+        dropped = behind;
+        sched->deadline_ns += behind * sched->period_ns;
+    }
+    else if (sched->policy == FRAME_LATE_SLIP || behind > FRAME_SCHED_MAX_CATCH_UP)
+    {
+        sched->deadline_ns = now;
+        slipped = 1;
+    }
+
+    int64_t phase = (int64_t)(now - sched->deadline_ns);
+
+    pthread_mutex_lock(&sched->lock);
+    frame_sched_stats *s = &sched->stats;
+    if (s->frames == 0 || phase < s->phase_min_ns)
+    {
+        s->phase_min_ns = phase;
+    }
+    if (s->frames == 0 || phase > s->phase_max_ns)
+    {
+        s->phase_max_ns = phase;
+    }
+    s->frames++;
+    s->late += (behind > 0);
+    s->skipped += dropped;
+    s->slips += slipped;
+    sched->phase_sum += phase;
+    sched->phase_sum_sq += (double)phase * phase;
+    pthread_mutex_unlock(&sched->lock);
+
+    // The next frame is due one period after this one's deadline
+    sched->deadline_ns += sched->period_ns;
+    return (int)dropped;
+}
+
+/******************************************************************************
+* function: frame_sched_get_stats
+* brief: Copy the phase statistics, with mean and deviation filled in
+******************************************************************************/
+void frame_sched_get_stats(frame_sched *sched, frame_sched_stats *stats)
+{
+    pthread_mutex_lock(&sched->lock);
+    *stats = sched->stats;
+    if (stats->frames > 0)
+    {
+        double mean = sched->phase_sum / stats->frames;
+        double var = sched->phase_sum_sq / stats->frames - mean * mean;
+
+        stats->phase_mean_ns = mean;
+        stats->phase_stddev_ns = (var > 0.0) ? sqrt(var) : 0.0;
+    }
+    pthread_mutex_unlock(&sched->lock);
+}
+
+const char *frame_late_policy_name(frame_late_policy policy)
+{
+    switch (policy)
+    {
+    case FRAME_LATE_SKIP:
+        return "skip";
+    case FRAME_LATE_CATCH_UP:
+        return "catch-up";
+    case FRAME_LATE_SLIP:
+        return "slip";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,124 @@
+/******************************************************************************
+* FRAME_SCHED.H
+*
+* This header file defines the frame scheduler that paces playback. It
+* provides functions for:
+*   - Releasing frames on a fixed timeline of absolute deadlines
+*   - Changing the frame rate without restarting the timeline
+*   - Handling frames that start after their deadline (skip, catch up, slip)
+*   - Reading the phase statistics: how far from its deadline each frame
+*     actually started
+*
+* Deadlines are start + n * period on CLOCK_MONOTONIC and the scheduler
+* sleeps until them with clock_nanosleep(TIMER_ABSTIME). The time spent on
+* a frame therefore never adds to the next period, so there is no drift,
+* and a late wake-up is not carried over into the following frames.
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+*
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#ifndef FRAME_SCHED_H
+#define FRAME_SCHED_H
+
+#include <stdint.h>             // for uint64_t
+#include <pthread.h>
+
+// Most periods FRAME_LATE_CATCH_UP runs behind before it gives up and
+// slips instead (e.g. after the process was stopped for a while)
+#define FRAME_SCHED_MAX_CATCH_UP 4
+
+// What to do with a frame that starts after its deadline
+typedef enum
+{
+    FRAME_LATE_SKIP = 0,        // drop the periods that passed, stay on the timeline
+    FRAME_LATE_CATCH_UP,        // run the missed frames back to back until on time
+    FRAME_LATE_SLIP             // start the timeline again from now
+} frame_late_policy;
+
+// Phase statistics since frame_sched_start; phase is the time between a
+// frame's deadline and the moment it was released
+typedef struct
+{
+    uint64_t frames;            // frames released
+    uint64_t late;              // frames released after their deadline's period
+    uint64_t skipped;           // periods dropped by FRAME_LATE_SKIP
+    uint64_t slips;             // timeline restarts
+    int64_t phase_min_ns;
+    int64_t phase_max_ns;
+    double phase_mean_ns;
+    double phase_stddev_ns;     // jitter
+} frame_sched_stats;
+
+// Scheduler state; the statistics may be read from any thread
+typedef struct
+{
+    pthread_mutex_t lock;
+    uint64_t period_ns;
+    uint64_t deadline_ns;       // of the next frame
+    frame_late_policy policy;
+    frame_sched_stats stats;
+    double phase_sum;
+    double phase_sum_sq;
+} frame_sched;
+
+// Static initializer; a scheduler's statistics can be read before it starts
+#define FRAME_SCHED_INITIALIZER { .lock = PTHREAD_MUTEX_INITIALIZER }
+
+/******************************************************************************
+ * Start a timeline whose first deadline is now, clearing the statistics.
+ * The scheduler must have been set up with FRAME_SCHED_INITIALIZER.
+ *
+ * param sched - scheduler
+ * param fps - frames per second
+ * param policy - late-frame policy
+ *******************************************************************************/
+void frame_sched_start(frame_sched *sched, int fps, frame_late_policy policy);
+
+/******************************************************************************
+ * Change the rate of a running timeline. The next deadline moves to one new
+ * period after the last frame's; later ones follow at the new period. Only
+ * the thread that waits on the scheduler may call this.
+ *
+ * param sched - scheduler
+ * param fps - frames per second
+ *******************************************************************************/
+void frame_sched_set_rate(frame_sched *sched, int fps);
+
+/******************************************************************************
+ * Wait for the next frame's deadline.
+ *
+ * Sleeps until the deadline if it is ahead. If it has passed, the policy
+ * decides: FRAME_LATE_SKIP moves to the current period, dropping the ones
+ * missed; FRAME_LATE_CATCH_UP returns at once and keeps the deadlines, so
+ * the following frames follow without sleeping until the timeline is met
+ * again; FRAME_LATE_SLIP restarts the timeline from now.
+ *
+ * param sched - scheduler
+ * returns the number of periods dropped; a file player skips as many
+ *         frames to keep the picture in time
+ *******************************************************************************/
+int frame_sched_wait(frame_sched *sched);
+
+/******************************************************************************
+ * Copy the phase statistics.
+ *******************************************************************************/
+void frame_sched_get_stats(frame_sched *sched, frame_sched_stats *stats);
+
+/******************************************************************************
+ * Name of a late-frame policy, for logs.
+ *******************************************************************************/
+const char *frame_late_policy_name(frame_late_policy policy);
+
+#endif /* FRAME_SCHED_H */
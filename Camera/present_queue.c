@@ -0,0 +1,278 @@
+/******************************************************************************
+* PRESENT_QUEUE.C
+*
+* Implementation of the triple-buffered present queue. Each buffer is free,
+* being filled by a producer, queued, or being sent by the present thread.
+* All state changes happen under one mutex and are announced on one
+* condition variable; with three buffers and a single queue slot there are
+* never more than a handful of waiters, so a broadcast is cheap.
+*
+* The present thread holds no buffer between frames: once the callback
+* returns the frame goes straight back to the free list. Anything the
+* callback needs from the previous frame (e.g. the panel contents for
+* partial updates) it has to keep itself.
+*
+* Dependencies:
+*   - pthread.h - POSIX threads
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "present_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+// Buffer states
+enum
+{
+    BUFFER_FREE = 0,
+    BUFFER_FILLING,
+    BUFFER_QUEUED,
+    BUFFER_SENDING
+};
+
+// Queue state, protected by 'lock'; 'changed' is broadcast on every change
+static struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    pthread_t thread;
+    int running;
+    int stopping;
+    uint8_t *buffers[PRESENT_QUEUE_BUFFERS];
+    int state[PRESENT_QUEUE_BUFFERS];
+    int queued;                 // index of the frame waiting to be sent, -1 if none
+    present_fn fn;
+    void *ctx;
+} queue =
+{
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .changed = PTHREAD_COND_INITIALIZER,
+    .queued = -1,
+};
+
+/******************************************************************************
+* function: buffer_index
+* brief: Find the slot of a buffer handed out by present_queue_acquire
+******************************************************************************/
+static int buffer_index(const uint8_t *frame)
+{
+    for (int i = 0; i < PRESENT_QUEUE_BUFFERS; i++)
+    {
+        if (queue.buffers[i] == frame)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/******************************************************************************
+* function: set_state
+* brief: Change a buffer's state and wake everyone waiting (lock held)
+******************************************************************************/
+static void set_state(int index, int state)
+{
+    queue.state[index] = state;
+    pthread_cond_broadcast(&queue.changed);
+}
+
+/******************************************************************************
+* function: present_thread_func
+* brief: Present thread; sends queued frames until stopped and drained
+******************************************************************************/
+static void *present_thread_func(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&queue.lock);
+
+    for (;;)
+    {
+        while (queue.queued < 0 && !queue.stopping)
+        {
+            pthread_cond_wait(&queue.changed, &queue.lock);
+        }
+        if (queue.queued < 0)
+        {
+            break;
+        }
+
+        int index = queue.queued;
+        queue.queued = -1;
+        set_state(index, BUFFER_SENDING);
+        pthread_mutex_unlock(&queue.lock);
+
+        queue.fn(queue.buffers[index], queue.ctx);
+
+        pthread_mutex_lock(&queue.lock);
+        set_state(index, BUFFER_FREE);
+    }
+
+    pthread_mutex_unlock(&queue.lock);
+    return NULL;
+}
+
+/******************************************************************************
+* function: free_buffers
+* brief: Free the frame buffers (thread not running)
+******************************************************************************/
+static void free_buffers(void)
+{
+    for (int i = 0; i < PRESENT_QUEUE_BUFFERS; i++)
+    {
+        free(queue.buffers[i]);
+        queue.buffers[i] = NULL;
+        queue.state[i] = BUFFER_FREE;
+    }
+}
+
+/******************************************************************************
+* function: present_queue_start
+* brief: Allocate the frame buffers and start the present thread
+*
+* Parameters:
+*   frame_bytes - size of one frame buffer
+*   fn - present callback
+*   ctx - context passed to fn
+*
+* returns 0 on success (or if already running), -1 on failure
+******************************************************************************/
+int present_queue_start(size_t frame_bytes, present_fn fn, void *ctx)
+{
+    if (queue.running)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < PRESENT_QUEUE_BUFFERS; i++)
+    {
+        // Start out black
+        queue.buffers[i] = calloc(1, frame_bytes);
+        if (queue.buffers[i] == NULL)
+        {
+            perror("Failed to allocate present buffer");
+            free_buffers();
+            return -1;
+        }
+    }
+
+    queue.fn = fn;
+    queue.ctx = ctx;
+    queue.queued = -1;
+    queue.stopping = 0;
+
+    if (pthread_create(&queue.thread, NULL, present_thread_func, NULL) != 0)
+    {
+        perror("Failed to create present thread");
+        free_buffers();
+        return -1;
+    }
+
+    queue.running = 1;
+    return 0;
+}
+
+/******************************************************************************
+* function: present_queue_stop
+* brief: Present what is still queued, then stop the thread and free buffers
+******************************************************************************/
+void present_queue_stop(void)
+{
+    if (!queue.running)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&queue.lock);
+    queue.stopping = 1;
+    pthread_cond_broadcast(&queue.changed);
+    pthread_mutex_unlock(&queue.lock);
+
+    pthread_join(queue.thread, NULL);
+    queue.running = 0;
+    free_buffers();
+}
+
+int present_queue_running(void)
+{
+    return queue.running;
+}
+
+/******************************************************************************
+* function: present_queue_acquire
+* brief: Take a free frame buffer, waiting for one if all are in flight
+******************************************************************************/
+uint8_t *present_queue_acquire(void)
+{
+    if (!queue.running)
+    {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&queue.lock);
+    for (;;)
+    {
+        for (int i = 0; i < PRESENT_QUEUE_BUFFERS; i++)
+        {
+            if (queue.state[i] == BUFFER_FREE)
+            {
+                queue.state[i] = BUFFER_FILLING;
+                pthread_mutex_unlock(&queue.lock);
+                return queue.buffers[i];
+            }
+        }
+        pthread_cond_wait(&queue.changed, &queue.lock);
+    }
+}
+
+/******************************************************************************
+* function: present_queue_submit
+* brief: Queue a filled buffer, waiting while another frame is queued
+******************************************************************************/
+void present_queue_submit(uint8_t *frame)
+{
+    int index = buffer_index(frame);
+    if (index < 0)
+    {
+        fprintf(stderr, "Frame not from the present queue\n");
+        return;
+    }
+
+    pthread_mutex_lock(&queue.lock);
+    while (queue.queued >= 0)
+    {
+        pthread_cond_wait(&queue.changed, &queue.lock);
+    }
+    queue.queued = index;
+    set_state(index, BUFFER_QUEUED);
+    pthread_mutex_unlock(&queue.lock);
+}
+
+/******************************************************************************
+* function: present_queue_release
+* brief: Give back an acquired buffer without presenting it
+******************************************************************************/
+void present_queue_release(uint8_t *frame)
+{
+    int index = buffer_index(frame);
+    if (index < 0)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&queue.lock);
+    set_state(index, BUFFER_FREE);
+    pthread_mutex_unlock(&queue.lock);
+}
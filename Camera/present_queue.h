@@ -0,0 +1,94 @@
+/******************************************************************************
+* PRESENT_QUEUE.H
+*
+* This header file defines the triple-buffered queue between frame
+* conversion and the display transfer. It provides functions for:
+*   - Starting and stopping a present thread that sends queued frames
+*   - Taking a free frame buffer to convert or draw into
+*   - Queueing a finished frame for the present thread
+*
+* The present thread owns the SPI transfer, so frame N+1 is converted while
+* frame N is being clocked out. Of the three buffers one is being sent, one
+* can wait in the queue and one is being filled; a producer that gets ahead
+* of the transfer waits in present_queue_submit until the queued frame has
+* been taken, so every frame is shown, in order.
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+*
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#ifndef PRESENT_QUEUE_H
+#define PRESENT_QUEUE_H
+
+#include <stdint.h>             // for uint8_t (8-bit unsigned integer)
+#include <stddef.h>             // defines size_t
+
+// Frame buffers in flight: being sent, queued, being filled
+#define PRESENT_QUEUE_BUFFERS 3
+
+/******************************************************************************
+ * Present callback, run on the present thread for every queued frame.
+ *
+ * param frame - finished frame; it is reused once the callback returns
+ * param ctx - context passed to present_queue_start
+ *******************************************************************************/
+typedef void (*present_fn)(const uint8_t *frame, void *ctx);
+
+/******************************************************************************
+ * Allocate the frame buffers and start the present thread.
+ *
+ * param frame_bytes - size of one frame buffer
+ * param fn - present callback
+ * param ctx - context passed to fn
+ * returns 0 on success (or if already running), -1 on failure
+ *******************************************************************************/
+int present_queue_start(size_t frame_bytes, present_fn fn, void *ctx);
+
+/******************************************************************************
+ * Present the frames still queued, stop the present thread and free the
+ * buffers.
+ *******************************************************************************/
+void present_queue_stop(void);
+
+/******************************************************************************
+ * Check whether the present thread is running.
+ *******************************************************************************/
+int present_queue_running(void);
+
+/******************************************************************************
+ * Take a free frame buffer, waiting for one if all are in flight.
+ *
+ * returns the buffer, or NULL if the queue is not running
+ *******************************************************************************/
+uint8_t *present_queue_acquire(void);
+
+/******************************************************************************
+ * Queue a filled buffer for presentation.
+ *
+ * Waits while another frame is still queued, so a producer faster than
+ * the display is held back instead of frames being dropped.
+ *
+ * param frame - buffer from present_queue_acquire
+ *******************************************************************************/
+void present_queue_submit(uint8_t *frame);
+
+/******************************************************************************
+ * Give back an acquired buffer without presenting it (e.g. when the
+ * conversion failed).
+ *
+ * param frame - buffer from present_queue_acquire
+ *******************************************************************************/
+void present_queue_release(uint8_t *frame);
+
+#endif /* PRESENT_QUEUE_H */
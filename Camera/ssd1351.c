@@ -0,0 +1,664 @@
+/******************************************************************************
+* SSD1351.C
+*
+* Implementation of low-level SSD1351 access. Commands are sent with DC low
+* and their arguments with DC high, as the controller expects. Pixel data is
+* streamed from the caller's buffer with a single DC/CS setup, either in
+* large DEV_SPI_Write_nByte calls of the Waveshare DEV_Config layer, or,
+* once ssd1351_spi_open has opened the spidev node, as SPI_IOC_MESSAGE
+* ioctls. A full frame therefore takes 8 SPI calls (one ioctl when spidev's
+* buffer holds a frame) instead of the 32768 per-byte writes of
+* OLED_1in5_rgb_Display.
+*
+* On the spidev path each row of a rectangle becomes one transfer pointing
+* into the frame, so narrow rectangles are neither copied nor split into
+* many calls: one message carries up to SSD1351_SPI_MAX_XFERS rows and as
+* many bytes as spidev's bufsiz allows. The transfers of a message are
+* clocked out back to back with CS held, and DC only changes between
+* messages, so nothing is done per byte.
+*
+* A bus set with ssd1351_set_bus (the emulator, ssd1351_emu.c) replaces
+* GPIO and SPI altogether: it receives each command and data block with
+* its DC level, exactly as it would appear on the wire.
+*
+* Partial updates compare the new frame with the one on the panel in 16x16
+* tiles. Unchanged tiles are never sent, and a frame without changed tiles
+* sends nothing at all. Runs of changed tiles are shrunk to the pixels that
+* actually changed, merged where one window is cheaper than two, and each
+* rectangle goes through its own column/row window. A HUD frame where one
+* text field changed costs a few hundred bytes on the bus instead of 32 KB.
+*
+* Interlaced updates (ssd1351_write_field) send every other row, each
+* through a one-row window under a column window set once per field.
+*
+* Dependencies:
+*   - DEV_Config.h - Waveshare SPI and GPIO helpers
+*   - linux/spi/spidev.h - SPI_IOC_MESSAGE transfers
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "ssd1351.h"
+#include "DEV_Config.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+
+#define SSD1351_PITCH (SSD1351_WIDTH * 2)
+
+// spidev's per-message buffer size, set with the spidev.bufsiz module parameter
+#define SPIDEV_BUFSIZ_PATH "/sys/module/spidev/parameters/bufsiz"
+
+// SPI transport. With a bus set, blocks go straight to it. With the spidev
+// node open ('fd' >= 0) data is queued as transfers pointing at the
+// caller's buffer and sent as one message per 'budget' bytes; otherwise it
+// is gathered into 'chunk' for DEV_SPI. Queued data must stay valid until
+// spi_flush.
+static struct
+{
+    ssd1351_bus_fn bus;
+    int dc;
+    int fd;
+    volatile uint32_t speed_hz;
+    size_t budget;
+    struct spi_ioc_transfer xfer[SSD1351_SPI_MAX_XFERS];
+    int count;
+    size_t bytes;
+    uint8_t chunk[SSD1351_SPI_CHUNK];
+    size_t used;
+} spi =
+{
+    .fd = -1,
+};
+
+/******************************************************************************
+* function: spidev_bufsiz
+* brief: Read the largest message spidev accepts
+******************************************************************************/
+static size_t spidev_bufsiz(void)
+{
+    FILE *f = fopen(SPIDEV_BUFSIZ_PATH, "r");
+    unsigned long bufsiz = 0;
+
+    if (f != NULL)
+    {
+        if (fscanf(f, "%lu", &bufsiz) != 1)
+        {
+            bufsiz = 0;
+        }
+        fclose(f);
+    }
+    return (bufsiz > 0) ? bufsiz : SSD1351_SPI_CHUNK;
+}
+
+/******************************************************************************
+* function: spi_flush
+* brief: Send everything queued with spi_queue
+*
+* If the ioctl fails the spidev node is closed and the batch, like all later
+* data, goes through DEV_SPI instead, so the frame still completes.
+******************************************************************************/
+static void spi_flush(void)
+{
+    if (spi.count > 0)
+    {
+        if (ioctl(spi.fd, SPI_IOC_MESSAGE(spi.count), spi.xfer) < 0)
+        {
+            perror("SPI_IOC_MESSAGE failed, using DEV_SPI");
+            close(spi.fd);
+            spi.fd = -1;
+            for (int i = 0; i < spi.count; i++)
+            {
+                DEV_SPI_Write_nByte((uint8_t *)(uintptr_t)spi.xfer[i].tx_buf, spi.xfer[i].len);
+            }
+        }
+        spi.count = 0;
+        spi.bytes = 0;
+    }
+
+    if (spi.used > 0)
+    {
+        DEV_SPI_Write_nByte(spi.chunk, (uint32_t)spi.used);
+        spi.used = 0;
+    }
+}
+
+/******************************************************************************
+* function: spi_queue
+* brief: Queue bytes for the current DC/CS setup, sending full batches
+******************************************************************************/
+static void spi_queue(const uint8_t *data, size_t len)
+{
+    if (spi.bus != NULL)
+    {
+        spi.bus(spi.dc, data, len);
+        return;
+    }
+
+    while (len > 0)
+    {
+        size_t piece;
+
+        if (spi.fd >= 0)
+        {
+            if (spi.count == SSD1351_SPI_MAX_XFERS || spi.bytes == spi.budget)
+            {
+                // May fall back to DEV_SPI, so look at the transport again
+                spi_flush();
+                continue;
+            }
+            piece = spi.budget - spi.bytes;
+            piece = (len < piece) ? len : piece;
+            spi.xfer[spi.count++] = (struct spi_ioc_transfer)
+            {
+                .tx_buf = (uintptr_t)data,
+                .len = (uint32_t)piece,
+                .speed_hz = spi.speed_hz,
+                .bits_per_word = 8,
+            };
+            spi.bytes += piece;
+        }
+        else if (spi.used == 0 && len >= SSD1351_SPI_CHUNK)
+        {
+            // Contiguous data goes out from the caller's buffer; the SPI
+            // layer only reads it, the cast drops const for its API
+            piece = SSD1351_SPI_CHUNK;
+            DEV_SPI_Write_nByte((uint8_t *)data, (uint32_t)piece);
+        }
+        else
+        {
+            // Short pieces (rows of narrow rectangles) are gathered so the
+            // SPI calls stay large
+            piece = SSD1351_SPI_CHUNK - spi.used;
+            piece = (len < piece) ? len : piece;
+            memcpy(spi.chunk + spi.used, data, piece);
+            spi.used += piece;
+            if (spi.used == SSD1351_SPI_CHUNK)
+            {
+                spi_flush();
+            }
+        }
+
+        data += piece;
+        len -= piece;
+    }
+}
+
+/******************************************************************************
+* function: spi_begin
+* brief: Set DC and select the panel for a command or data block
+******************************************************************************/
+static void spi_begin(int dc)
+{
+    spi.dc = dc;
+    if (spi.bus != NULL)
+    {
+        return;
+    }
+
+    if (dc)
+    {
+        OLED_DC_1;
+    }
+    else
+    {
+        OLED_DC_0;
+    }
+    OLED_CS_0;
+}
+
+/******************************************************************************
+* function: spi_end
+* brief: Send what is queued and deselect the panel
+******************************************************************************/
+static void spi_end(void)
+{
+    spi_flush();
+    if (spi.bus == NULL)
+    {
+        OLED_CS_1;
+    }
+}
+
+/******************************************************************************
+* function: ssd1351_set_bus
+* brief: Send commands and data to a bus function instead of GPIO/SPI
+******************************************************************************/
+void ssd1351_set_bus(ssd1351_bus_fn bus)
+{
+    spi_flush();
+    spi.bus = bus;
+}
+
+/******************************************************************************
+* function: ssd1351_spi_open
+* brief: Send through the spidev node instead of DEV_SPI
+*
+* Parameters:
+*   device - spidev node the panel is on
+*   speed_hz - SPI clock
+*
+* returns 0 on success, -1 on failure (DEV_SPI stays in use)
+******************************************************************************/
+int ssd1351_spi_open(const char *device, uint32_t speed_hz)
+{
+    uint8_t mode = SPI_MODE_0;
+    uint8_t bits = 8;
+
+    ssd1351_spi_close();
+
+    int fd = open(device, O_RDWR);
+    if (fd < 0)
+    {
+        perror("Failed to open spidev");
+        return -1;
+    }
+    if (ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+        ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+        ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed_hz) < 0)
+    {
+        perror("Failed to configure spidev");
+        close(fd);
+        return -1;
+    }
+
+    spi.budget = spidev_bufsiz();
+    spi.speed_hz = speed_hz;
+    spi.fd = fd;
+    return 0;
+}
+
+/******************************************************************************
+* function: ssd1351_spi_set_speed
+* brief: Change the SPI clock of the spidev transfers
+******************************************************************************/
+void ssd1351_spi_set_speed(uint32_t speed_hz)
+{
+    // Every transfer carries its own clock, so this takes effect with the
+    // next message without touching the device
+    spi.speed_hz = speed_hz;
+}
+
+/******************************************************************************
+* function: ssd1351_spi_close
+* brief: Close the spidev node and go back to DEV_SPI
+******************************************************************************/
+void ssd1351_spi_close(void)
+{
+    if (spi.fd >= 0)
+    {
+        close(spi.fd);
+        spi.fd = -1;
+    }
+    spi.count = 0;
+    spi.bytes = 0;
+}
+
+int ssd1351_spi_is_open(void)
+{
+    return spi.fd >= 0;
+}
+
+/******************************************************************************
+* function: ssd1351_command
+* brief: Send a command byte and its arguments
+******************************************************************************/
+void ssd1351_command(uint8_t cmd, const uint8_t *args, size_t nargs)
+{
+    spi_begin(0);
+    spi_queue(&cmd, 1);
+    spi_end();
+
+    if (nargs > 0)
+    {
+        ssd1351_write_data(args, nargs);
+    }
+}
+
+/******************************************************************************
+* function: ssd1351_write_data
+* brief: Stream data bytes in large transfers with one DC/CS setup
+******************************************************************************/
+void ssd1351_write_data(const uint8_t *data, size_t len)
+{
+    spi_begin(1);
+    spi_queue(data, len);
+    spi_end();
+}
+
+/******************************************************************************
+* function: ssd1351_set_window
+* brief: Set the inclusive column/row window and start a RAM write
+******************************************************************************/
+void ssd1351_set_window(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1)
+{
+    uint8_t columns[2] = { x0, x1 };
+    uint8_t rows[2] = { y0, y1 };
+
+    ssd1351_command(SSD1351_CMD_SET_COLUMN, columns, sizeof(columns));
+    ssd1351_command(SSD1351_CMD_SET_ROW, rows, sizeof(rows));
+    ssd1351_command(SSD1351_CMD_WRITE_RAM, NULL, 0);
+}
+
+/******************************************************************************
+* function: ssd1351_gamma_table
+* brief: Build an increasing gray scale table for a power-law response
+******************************************************************************/
+void ssd1351_gamma_table(double gamma, uint8_t *table)
+{
+    int prev = 0;
+
+    for (int level = 1; level <= SSD1351_GRAY_LEVELS; level++)
+    {
+        int width = (int)lround(SSD1351_GRAY_MAX_PULSE * pow((double)level / SSD1351_GRAY_LEVELS, gamma));
+
+        // At least one more than the level below, and room left for the
+        // levels above
+        int lowest = prev + 1;
+        int highest = SSD1351_GRAY_MAX_PULSE - (SSD1351_GRAY_LEVELS - level);
+        width = (width < lowest) ? lowest : (width > highest) ? highest : width;
+
+        table[level - 1] = (uint8_t)width;
+        prev = width;
+    }
+}
+
+/******************************************************************************
+* function: ssd1351_set_levels
+* brief: Program the gray scale table, contrast and master current
+******************************************************************************/
+void ssd1351_set_levels(const uint8_t *gray_table, const uint8_t contrast[3], uint8_t master)
+{
+    uint8_t step = (master > SSD1351_MASTER_MAX) ? SSD1351_MASTER_MAX : master;
+
+    if (gray_table != NULL)
+    {
+        ssd1351_command(SSD1351_CMD_GRAY_TABLE, gray_table, SSD1351_GRAY_LEVELS);
+    }
+    else
+    {
+        ssd1351_command(SSD1351_CMD_LINEAR_GRAY, NULL, 0);
+    }
+    ssd1351_command(SSD1351_CMD_CONTRAST, contrast, 3);
+    ssd1351_command(SSD1351_CMD_MASTER, &step, 1);
+}
+
+/******************************************************************************
+* function: ssd1351_write_frame
+* brief: Send a full big-endian RGB565 frame
+******************************************************************************/
+void ssd1351_write_frame(const uint8_t *frame)
+{
+    ssd1351_set_window(0, 0, SSD1351_WIDTH - 1, SSD1351_HEIGHT - 1);
+    ssd1351_write_data(frame, SSD1351_FRAME_BYTES);
+}
+
+/******************************************************************************
+* function: ssd1351_write_rect
+* brief: Send one rectangle of a full frame through its own window
+******************************************************************************/
+void ssd1351_write_rect(const uint8_t *frame, const ssd1351_rect *rect)
+{
+    int rows = rect->y1 - rect->y0 + 1;
+    size_t span = (size_t)(rect->x1 - rect->x0 + 1) * 2;
+    const uint8_t *src = frame + rect->y0 * SSD1351_PITCH + rect->x0 * 2;
+
+    ssd1351_set_window(rect->x0, rect->y0, rect->x1, rect->y1);
+
+    // Full-width rows are contiguous in the frame
+    if (span == SSD1351_PITCH)
+    {
+        ssd1351_write_data(src, rows * span);
+        return;
+    }
+
+    // Narrower rows are queued one by one: a transfer each on spidev,
+    // gathered into large DEV_SPI calls otherwise
+    spi_begin(1);
+    for (int row = 0; row < rows; row++)
+    {
+        spi_queue(src + row * SSD1351_PITCH, span);
+    }
+    spi_end();
+}
+
+/******************************************************************************
+* function: ssd1351_write_field
+* brief: Send the even or odd rows of a frame through one-row windows
+******************************************************************************/
+size_t ssd1351_write_field(const uint8_t *frame, const uint8_t *prev, int field)
+{
+    uint8_t columns[2] = { 0, SSD1351_WIDTH - 1 };
+    size_t bytes = 0;
+
+    ssd1351_command(SSD1351_CMD_SET_COLUMN, columns, sizeof(columns));
+    for (int y = field & 1; y < SSD1351_HEIGHT; y += 2)
+    {
+        const uint8_t *src = frame + y * SSD1351_PITCH;
+
+        if (prev != NULL && memcmp(src, prev + y * SSD1351_PITCH, SSD1351_PITCH) == 0)
+        {
+            continue;
+        }
+
+        // The row's pixels fill the one-row window exactly
+        uint8_t rows[2] = { (uint8_t)y, (uint8_t)y };
+        ssd1351_command(SSD1351_CMD_SET_ROW, rows, sizeof(rows));
+        ssd1351_command(SSD1351_CMD_WRITE_RAM, NULL, 0);
+        ssd1351_write_data(src, SSD1351_PITCH);
+        bytes += SSD1351_PITCH;
+    }
+    return bytes;
+}
+
+/******************************************************************************
+* function: ssd1351_dirty_tiles
+* brief: Find the tiles in which two frames differ
+******************************************************************************/
+uint64_t ssd1351_dirty_tiles(const uint8_t *frame, const uint8_t *prev)
+{
+    uint64_t tiles = 0;
+
+    for (int ty = 0; ty < SSD1351_TILES_Y; ty++)
+    {
+        for (int tx = 0; tx < SSD1351_TILES_X; tx++)
+        {
+            size_t offset = ty * SSD1351_TILE * SSD1351_PITCH + tx * SSD1351_TILE * 2;
+
+            for (int row = 0; row < SSD1351_TILE; row++, offset += SSD1351_PITCH)
+            {
+                if (memcmp(frame + offset, prev + offset, SSD1351_TILE * 2) != 0)
+                {
+                    tiles |= SSD1351_TILE_BIT(tx, ty);
+                    break;
+                }
+            }
+        }
+    }
+    return tiles;
+}
+
+/******************************************************************************
+* function: shrink_rect
+* brief: Shrink a rectangle to the bounding box of the pixels that differ
+*
+* returns 1 if any pixel in the rectangle differs, 0 otherwise
+******************************************************************************/
+static int shrink_rect(const uint8_t *frame, const uint8_t *prev, ssd1351_rect *rect)
+{
+    int x0 = rect->x1 + 1, x1 = -1;
+    int y0 = -1, y1 = -1;
+
+    for (int y = rect->y0; y <= rect->y1; y++)
+    {
+        const uint8_t *a = frame + y * SSD1351_PITCH;
+        const uint8_t *b = prev + y * SSD1351_PITCH;
+        int first = rect->x0;
+        int last = rect->x1;
+
+        if (memcmp(a + first * 2, b + first * 2, (last - first + 1) * 2) == 0)
+        {
+            continue;
+        }
+        while (memcmp(a + first * 2, b + first * 2, 2) == 0)
+        {
+            first++;
+        }
+        while (memcmp(a + last * 2, b + last * 2, 2) == 0)
+        {
+            last--;
+        }
+
+        x0 = (first < x0) ? first : x0;
+        x1 = (last > x1) ? last : x1;
+        if (y0 < 0)
+        {
+            y0 = y;
+        }
+        y1 = y;
+    }
+
+    if (y0 < 0)
+    {
+        return 0;
+    }
+    *rect = (ssd1351_rect){ x0, y0, x1, y1 };
+    return 1;
+}
+
+// Pixel area of a rectangle
+static int rect_area(const ssd1351_rect *r)
+{
+    return (r->x1 - r->x0 + 1) * (r->y1 - r->y0 + 1);
+}
+
+// Smallest rectangle covering both
+static ssd1351_rect rect_union(const ssd1351_rect *a, const ssd1351_rect *b)
+{
+    return (ssd1351_rect){ (a->x0 < b->x0) ? a->x0 : b->x0, (a->y0 < b->y0) ? a->y0 : b->y0,
+                           (a->x1 > b->x1) ? a->x1 : b->x1, (a->y1 > b->y1) ? a->y1 : b->y1 };
+}
+
+/******************************************************************************
+* function: add_rect
+* brief: Add a changed area to the list, merging it where that is cheaper
+*
+* The area joins the rectangle whose union with it covers the fewest extra
+* pixels, if those are worth less than a window of their own, or in any
+* case once the list is full.
+******************************************************************************/
+static void add_rect(ssd1351_rect *rects, int *count, int max_rects, const ssd1351_rect *area)
+{
+    int best = -1;
+    int best_waste = 0;
+
+    for (int i = 0; i < *count; i++)
+    {
+        ssd1351_rect merged = rect_union(&rects[i], area);
+        int waste = rect_area(&merged) - rect_area(&rects[i]) - rect_area(area);
+
+        if (best < 0 || waste < best_waste)
+        {
+            best = i;
+            best_waste = waste;
+        }
+    }
+
+    if (best >= 0 && (best_waste * 2 <= SSD1351_WINDOW_COST || *count == max_rects))
+    {
+        rects[best] = rect_union(&rects[best], area);
+        return;
+    }
+    rects[(*count)++] = *area;
+}
+
+/******************************************************************************
+* function: ssd1351_dirty_rects
+* brief: Find the rectangles in which two frames differ
+******************************************************************************/
+int ssd1351_dirty_rects(const uint8_t *frame, const uint8_t *prev,
+                        ssd1351_rect *rects, int max_rects)
+{
+    uint64_t tiles = ssd1351_dirty_tiles(frame, prev);
+    int count = 0;
+
+    // Each run of changed tiles in a tile row, shrunk to the pixels that
+    // actually changed, is one candidate area
+    for (int ty = 0; ty < SSD1351_TILES_Y && tiles; ty++)
+    {
+        for (int tx = 0; tx < SSD1351_TILES_X; tx++)
+        {
+            if (!(tiles & SSD1351_TILE_BIT(tx, ty)))
+            {
+                continue;
+            }
+
+            int run_end = tx;
+            while (run_end + 1 < SSD1351_TILES_X && (tiles & SSD1351_TILE_BIT(run_end + 1, ty)))
+            {
+                run_end++;
+            }
+
+            ssd1351_rect area =
+            {
+                tx * SSD1351_TILE, ty * SSD1351_TILE,
+                (run_end + 1) * SSD1351_TILE - 1, (ty + 1) * SSD1351_TILE - 1
+            };
+            shrink_rect(frame, prev, &area);
+            add_rect(rects, &count, max_rects, &area);
+            tx = run_end;
+        }
+    }
+
+    return count;
+}
+
+/******************************************************************************
+* function: ssd1351_write_changes
+* brief: Send only the rectangles that differ from the frame on the panel
+******************************************************************************/
+size_t ssd1351_write_changes(const uint8_t *frame, const uint8_t *prev)
+{
+    ssd1351_rect rects[SSD1351_MAX_RECTS];
+    size_t bytes = 0;
+
+    if (prev == NULL)
+    {
+        ssd1351_write_frame(frame);
+        return SSD1351_FRAME_BYTES;
+    }
+
+    int count = ssd1351_dirty_rects(frame, prev, rects, SSD1351_MAX_RECTS);
+    for (int i = 0; i < count; i++)
+    {
+        bytes += (size_t)(rects[i].x1 - rects[i].x0 + 1) * (rects[i].y1 - rects[i].y0 + 1) * 2;
+    }
+
+    // Mostly-changed frames (live video) go out in one window
+    if (bytes + count * SSD1351_WINDOW_COST >= SSD1351_FRAME_BYTES + SSD1351_WINDOW_COST)
+    {
+        ssd1351_write_frame(frame);
+        return SSD1351_FRAME_BYTES;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        ssd1351_write_rect(frame, &rects[i]);
+    }
+    return bytes;
+}
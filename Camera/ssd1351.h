@@ -0,0 +1,284 @@
+/******************************************************************************
+* SSD1351.H
+*
+* This header file defines low-level access to the SSD1351 OLED controller,
+* next to the Waveshare OLED_1in5_rgb driver. It provides functions for:
+*   - Sending commands and command arguments
+*   - Setting the column/row address window
+*   - Streaming pixel data in a few large SPI transfers
+*   - Partial updates that send only the tiles that changed since the
+*     previous frame, and nothing at all for an unchanged frame
+*
+* The Waveshare OLED_1in5_rgb_Display sends every byte with its own DC/CS
+* toggle and SPI call. These functions set DC/CS once per transfer and hand
+* the caller's buffer straight to the SPI layer. The frame the conversion
+* kernels write is then the same memory that goes out on the bus.
+*
+* By default the data goes through the Waveshare DEV_SPI helpers. After
+* ssd1351_spi_open it is sent with SPI_IOC_MESSAGE ioctls on the spidev node
+* instead, at a clock of the caller's choosing. spidev limits a message to
+* its bufsiz (4096 bytes unless the module is loaded with e.g.
+* spidev.bufsiz=32768, which lets a full frame go out in one ioctl).
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+*
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#ifndef SSD1351_H
+#define SSD1351_H
+
+#include <stdint.h>             // for uint8_t (8-bit unsigned integer)
+#include <stddef.h>             // defines size_t
+
+// Panel geometry (RGB565, 2 bytes per pixel, high byte first)
+#define SSD1351_WIDTH       128
+#define SSD1351_HEIGHT      128
+#define SSD1351_FRAME_BYTES (SSD1351_WIDTH * SSD1351_HEIGHT * 2)
+
+// Largest single SPI write; matches the spidev default buffer size
+#define SSD1351_SPI_CHUNK   4096
+
+// Most transfers (rectangle rows) batched into one SPI_IOC_MESSAGE
+#define SSD1351_SPI_MAX_XFERS 128
+
+// SSD1351 commands
+#define SSD1351_CMD_SET_COLUMN  0x15    // column start/end
+#define SSD1351_CMD_WRITE_RAM   0x5C    // following data goes to GDDRAM
+#define SSD1351_CMD_SET_ROW     0x75    // row start/end
+#define SSD1351_CMD_SET_REMAP   0xA0    // address increment, remap, color depth
+#define SSD1351_CMD_START_LINE  0xA1    // display start line
+#define SSD1351_CMD_OFFSET      0xA2    // display offset
+#define SSD1351_CMD_ALL_OFF     0xA4    // display mode: all pixels off
+#define SSD1351_CMD_ALL_ON      0xA5    // display mode: all pixels at GS63
+#define SSD1351_CMD_NORMAL      0xA6    // display mode: show GDDRAM
+#define SSD1351_CMD_INVERSE     0xA7    // display mode: show GDDRAM inverted
+#define SSD1351_CMD_DISPLAY_OFF 0xAE    // sleep mode on
+#define SSD1351_CMD_DISPLAY_ON  0xAF    // sleep mode off
+#define SSD1351_CMD_PHASE       0xB1    // reset and pre-charge periods
+#define SSD1351_CMD_CLOCK_DIV   0xB3    // clock divider, oscillator frequency
+#define SSD1351_CMD_GRAY_TABLE  0xB8    // gray scale pulse widths GS1-GS63
+#define SSD1351_CMD_LINEAR_GRAY 0xB9    // built-in linear gray scale table
+#define SSD1351_CMD_PRECHARGE   0xBB    // pre-charge voltage
+#define SSD1351_CMD_VCOMH       0xBE    // COM deselect voltage
+#define SSD1351_CMD_CONTRAST    0xC1    // contrast current of colors A, B, C
+#define SSD1351_CMD_MASTER      0xC7    // master contrast current
+#define SSD1351_CMD_LOCK        0xFD    // command lock
+
+// Command lock (SSD1351_CMD_LOCK) arguments
+#define SSD1351_UNLOCK          0x12    // accept commands
+#define SSD1351_LOCK            0x16    // ignore all but the lock command
+#define SSD1351_RESTRICTED_OFF  0xB0    // ignore A2, B1, B3, BB, BE and C1
+#define SSD1351_RESTRICTED_ON   0xB1    // accept them (Waveshare init)
+
+// Gray scale table: pulse widths (in DCLKs) of levels 1-63; level 0 is
+// always off. The widths must increase from level to level.
+#define SSD1351_GRAY_LEVELS     63
+#define SSD1351_GRAY_MAX_PULSE  180
+
+// Highest master current step: the contrast currents are scaled by
+// (step + 1) / 16
+#define SSD1351_MASTER_MAX      15
+
+// Most rectangles a partial update is split into; later changes are merged
+// into the last one
+#define SSD1351_MAX_RECTS   16
+
+// Cost of setting up one more address window (three commands, five SPI
+// calls), in bytes of pixel data that could be sent in the same time. Two
+// changed areas are sent as one rectangle when that wastes less than this.
+#define SSD1351_WINDOW_COST 192
+
+// Change detection works on square tiles; with 8x8 of them a frame's
+// changed tiles fit in one 64-bit mask
+#define SSD1351_TILE        16
+#define SSD1351_TILES_X     (SSD1351_WIDTH / SSD1351_TILE)
+#define SSD1351_TILES_Y     (SSD1351_HEIGHT / SSD1351_TILE)
+#define SSD1351_TILE_BIT(tx, ty) (1ULL << ((ty) * SSD1351_TILES_X + (tx)))
+
+// Inclusive pixel rectangle in panel coordinates
+typedef struct
+{
+    uint8_t x0;
+    uint8_t y0;
+    uint8_t x1;
+    uint8_t y1;
+} ssd1351_rect;
+
+/******************************************************************************
+ * Bus function receiving a command (dc 0) or data (dc 1) block as it would
+ * be clocked out with CS low.
+ *******************************************************************************/
+typedef void (*ssd1351_bus_fn)(int dc, const uint8_t *data, size_t len);
+
+/******************************************************************************
+ * Send all commands and data to a bus function instead of the GPIO/SPI
+ * layer, e.g. ssd1351_emu_write. NULL goes back to GPIO/SPI. Switch only
+ * while no other thread is sending.
+ *******************************************************************************/
+void ssd1351_set_bus(ssd1351_bus_fn bus);
+
+/******************************************************************************
+ * Send pixel data and commands through a spidev node instead of DEV_SPI.
+ *
+ * The node is set to SPI mode 0 and 8-bit words. DC and CS stay on the
+ * DEV_Config GPIOs and are set once per command or data block, outside the
+ * transfers. The transport is not locked: open, close and send from one
+ * thread, or while no other thread is sending.
+ *
+ * param device - spidev node, e.g. "/dev/spidev0.0"
+ * param speed_hz - SPI clock
+ * returns 0 on success, -1 on failure (DEV_SPI stays in use)
+ *******************************************************************************/
+int ssd1351_spi_open(const char *device, uint32_t speed_hz);
+
+/******************************************************************************
+ * Change the SPI clock of the spidev path; applies from the next transfer.
+ *******************************************************************************/
+void ssd1351_spi_set_speed(uint32_t speed_hz);
+
+/******************************************************************************
+ * Close the spidev node and go back to DEV_SPI.
+ *******************************************************************************/
+void ssd1351_spi_close(void);
+
+/******************************************************************************
+ * Check whether data goes through the spidev node.
+ *******************************************************************************/
+int ssd1351_spi_is_open(void);
+
+/******************************************************************************
+ * Send a command byte followed by its argument bytes.
+ *
+ * param cmd - command byte (sent with DC low)
+ * param args - argument bytes (sent with DC high), may be NULL if nargs is 0
+ * param nargs - number of argument bytes
+ *******************************************************************************/
+void ssd1351_command(uint8_t cmd, const uint8_t *args, size_t nargs);
+
+/******************************************************************************
+ * Stream data bytes to the controller.
+ *
+ * DC and CS are set once for the whole buffer, which is sent in chunks of
+ * at most SSD1351_SPI_CHUNK bytes, or in messages of up to spidev's bufsiz
+ * on the spidev path.
+ *******************************************************************************/
+void ssd1351_write_data(const uint8_t *data, size_t len);
+
+/******************************************************************************
+ * Set the GDDRAM address window and start a RAM write.
+ *
+ * Coordinates are inclusive. Pixel data written afterwards fills the
+ * window row by row.
+ *******************************************************************************/
+void ssd1351_set_window(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1);
+
+/******************************************************************************
+ * Build a gray scale table for a power-law response: level n gets a pulse
+ * width of SSD1351_GRAY_MAX_PULSE * (n / 63) ^ gamma, nudged where needed
+ * to keep the widths increasing.
+ *
+ * param gamma - exponent, e.g. 2.2; 1.0 is linear
+ * param table - receives SSD1351_GRAY_LEVELS pulse widths
+ *******************************************************************************/
+void ssd1351_gamma_table(double gamma, uint8_t *table);
+
+/******************************************************************************
+ * Program the drive levels: gray scale table, contrast and master current.
+ * The controller applies them to every pixel as it drives the panel, so
+ * dimming and gamma cost nothing per frame.
+ *
+ * The contrast command is only accepted while the restricted commands are
+ * unlocked (SSD1351_RESTRICTED_ON, as the Waveshare init sequence leaves
+ * them). Must not be interleaved with a frame transfer.
+ *
+ * param gray_table - SSD1351_GRAY_LEVELS pulse widths, NULL for the
+ *                    controller's built-in linear table
+ * param contrast - contrast current of colors A, B and C
+ * param master - master current step, 0 to SSD1351_MASTER_MAX
+ *******************************************************************************/
+void ssd1351_set_levels(const uint8_t *gray_table, const uint8_t contrast[3], uint8_t master);
+
+/******************************************************************************
+ * Send a full big-endian RGB565 frame (SSD1351_FRAME_BYTES bytes).
+ *******************************************************************************/
+void ssd1351_write_frame(const uint8_t *frame);
+
+/******************************************************************************
+ * Send one rectangle of a full big-endian RGB565 frame.
+ *
+ * The window is set to the rectangle and its rows are streamed with one
+ * DC/CS setup, gathered into transfers of up to SSD1351_SPI_CHUNK bytes,
+ * or, on the spidev path, sent as one transfer per row in a few messages.
+ *
+ * param frame - full frame (SSD1351_FRAME_BYTES bytes)
+ * param rect - area to send
+ *******************************************************************************/
+void ssd1351_write_rect(const uint8_t *frame, const ssd1351_rect *rect);
+
+/******************************************************************************
+ * Send one field (every other row) of a full big-endian RGB565 frame.
+ *
+ * The column window is set once; each row then gets its own one-row
+ * window, so a field costs half the pixel bytes of a frame plus a row
+ * command per row. Rows that are the same in 'prev' are left out.
+ *
+ * param frame - full frame (SSD1351_FRAME_BYTES bytes)
+ * param prev - frame currently on the panel, or NULL to send every row
+ * param field - 0 for the even rows, 1 for the odd rows
+ * returns the number of pixel bytes sent
+ *******************************************************************************/
+size_t ssd1351_write_field(const uint8_t *frame, const uint8_t *prev, int field);
+
+/******************************************************************************
+ * Find the tiles in which two frames differ.
+ *
+ * The frame is compared in SSD1351_TILE x SSD1351_TILE tiles; a tile's
+ * comparison stops at its first differing row, so changed tiles are cheap.
+ *
+ * param frame, prev - full frames to compare
+ * returns a mask with SSD1351_TILE_BIT(tx, ty) set for each changed tile,
+ *         0 if the frames are identical
+ *******************************************************************************/
+uint64_t ssd1351_dirty_tiles(const uint8_t *frame, const uint8_t *prev);
+
+/******************************************************************************
+ * Find the rectangles in which two frames differ.
+ *
+ * Each horizontal run of changed tiles is shrunk to the bounding box of
+ * the pixels that changed in it. Boxes are merged when the unchanged
+ * pixels a merge adds are worth less than SSD1351_WINDOW_COST, so a changed
+ * text field becomes one rectangle while fields in different parts of the
+ * panel, even on the same rows, stay separate.
+ *
+ * param frame, prev - full frames to compare
+ * param rects - receives the rectangles
+ * param max_rects - capacity of 'rects', at least 1
+ * returns the number of rectangles, 0 if the frames are identical
+ *******************************************************************************/
+int ssd1351_dirty_rects(const uint8_t *frame, const uint8_t *prev,
+                        ssd1351_rect *rects, int max_rects);
+
+/******************************************************************************
+ * Update the panel from 'prev' to 'frame', sending only what changed.
+ *
+ * Falls back to a full frame when 'prev' is NULL (panel content unknown) or
+ * when the changed rectangles and their windows would cost at least as much.
+ *
+ * param frame - new full frame
+ * param prev - frame currently on the panel, or NULL
+ * returns the number of pixel bytes sent
+ *******************************************************************************/
+size_t ssd1351_write_changes(const uint8_t *frame, const uint8_t *prev);
+
+#endif /* SSD1351_H */
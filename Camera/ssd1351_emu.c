@@ -0,0 +1,566 @@
+/******************************************************************************
+* SSD1351_EMU.C
+*
+* Software model of the SSD1351 and the display backend built on it. The
+* model decodes the byte stream the way the controller does: a byte with
+* DC low is a command, bytes with DC high are its arguments, or pixel data
+* after WRITE_RAM. Pixel data fills the column/row window in the order the
+* remap register selects, two bytes per pixel (65k colors).
+*
+* Only the registers that change what the panel shows are modeled; other
+* commands (clocks, voltages) are accepted and ignored. The drive levels
+* (gray scale table, contrast and master current) are recorded but not
+* applied to the rendered screen, which stays comparable to the frames
+* sent. 262k color depth is treated as 65k.
+*
+* Bus time is simulated per block: the writer is held until a bus running
+* at the configured clock would have clocked the block out. Time the sender
+* spends between blocks (e.g. diffing the next frame) counts as idle bus,
+* so the emulated transfer overlaps the rest of the pipeline just as the
+* real one does.
+*
+* Dependencies:
+*   - ssd1351.h - command stream, used by the backend
+*   - pthread.h - guards the model against readers on other threads
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "ssd1351_emu.h"
+#include "ssd1351.h"
+#include "display_backend.h"
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#define SSD1351_PITCH (SSD1351_WIDTH * 2)
+
+// Most argument bytes kept for one command (the gray scale table)
+#define EMU_MAX_ARGS SSD1351_GRAY_LEVELS
+
+// How far the simulated bus may be behind the writer before it sleeps:
+// waking up takes longer than a command byte takes on the bus, so sleeping
+// for every block would time many small blocks (row windows) far too slow
+#define EMU_SLEEP_SLACK_NS 100000
+
+// Drive levels after reset (datasheet defaults)
+#define EMU_RESET_LEVELS { .linear = 1, .contrast = { 0x8A, 0x51, 0x8A }, .master = 0x0F }
+
+// Display modes
+enum
+{
+    EMU_MODE_ALL_OFF = 0,
+    EMU_MODE_ALL_ON,
+    EMU_MODE_NORMAL,
+    EMU_MODE_INVERSE
+};
+
+// Controller state. 'lock' guards everything but the timing; bus_free is
+// only used by the thread that sends
+static struct
+{
+    pthread_mutex_t lock;
+    uint8_t gddram[SSD1351_FRAME_BYTES];
+    uint8_t cmd;                // last command
+    uint8_t args[EMU_MAX_ARGS];
+    int nargs;
+    int col0, col1, row0, row1; // address window
+    int col, row, half;         // RAM write pointer, byte within the pixel
+    uint8_t remap;
+    uint8_t start_line;
+    uint8_t offset;
+    int mode;
+    int on;
+    int locked;
+    int restricted;             // contrast and other restricted commands ignored
+    ssd1351_emu_levels levels;
+    ssd1351_emu_stats stats;
+
+    volatile uint32_t spi_hz;
+    volatile uint32_t call_ns;
+    struct timespec bus_free;   // when the simulated bus finishes
+} emu =
+{
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .col1 = SSD1351_WIDTH - 1,
+    .row1 = SSD1351_HEIGHT - 1,
+    .mode = EMU_MODE_NORMAL,
+    .restricted = 1,
+    .levels = EMU_RESET_LEVELS,
+    .spi_hz = SSD1351_EMU_SPI_HZ,
+};
+
+/******************************************************************************
+* function: ssd1351_emu_reset
+* brief: Put the emulated controller into its reset state
+******************************************************************************/
+void ssd1351_emu_reset(void)
+{
+    pthread_mutex_lock(&emu.lock);
+    memset(emu.gddram, 0, sizeof(emu.gddram));
+    emu.cmd = 0;
+    emu.nargs = 0;
+    emu.col0 = 0;
+    emu.col1 = SSD1351_WIDTH - 1;
+    emu.row0 = 0;
+    emu.row1 = SSD1351_HEIGHT - 1;
+    emu.col = 0;
+    emu.row = 0;
+    emu.half = 0;
+    emu.remap = 0;
+    emu.start_line = 0;
+    emu.offset = 0;
+    emu.mode = EMU_MODE_NORMAL;
+    emu.on = 0;
+    emu.locked = 0;
+    emu.restricted = 1;
+    emu.levels = (ssd1351_emu_levels)EMU_RESET_LEVELS;
+    memset(&emu.stats, 0, sizeof(emu.stats));
+    pthread_mutex_unlock(&emu.lock);
+}
+
+void ssd1351_emu_set_timing(uint32_t spi_hz, uint32_t call_ns)
+{
+    emu.spi_hz = spi_hz;
+    emu.call_ns = call_ns;
+}
+
+/******************************************************************************
+* function: emu_restricted
+* brief: Whether a command is ignored while the restricted ones are locked
+******************************************************************************/
+static int emu_restricted(uint8_t cmd)
+{
+    switch (cmd)
+    {
+    case SSD1351_CMD_OFFSET:
+    case SSD1351_CMD_PHASE:
+    case SSD1351_CMD_CLOCK_DIV:
+    case SSD1351_CMD_PRECHARGE:
+    case SSD1351_CMD_VCOMH:
+    case SSD1351_CMD_CONTRAST:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/******************************************************************************
+* function: emu_command
+* brief: Start a command; those without arguments take effect here
+******************************************************************************/
+static void emu_command(uint8_t cmd)
+{
+    emu.stats.commands++;
+
+    // A locked controller only listens for the unlock command; the
+    // restricted ones need their own unlock
+    if ((emu.locked && cmd != SSD1351_CMD_LOCK) ||
+        (emu.restricted && emu_restricted(cmd)))
+    {
+        emu.cmd = 0;
+        return;
+    }
+
+    emu.cmd = cmd;
+    emu.nargs = 0;
+
+    switch (cmd)
+    {
+    case SSD1351_CMD_WRITE_RAM:
+        emu.col = emu.col0;
+        emu.row = emu.row0;
+        emu.half = 0;
+        emu.stats.windows++;
+        break;
+    case SSD1351_CMD_ALL_OFF:
+        emu.mode = EMU_MODE_ALL_OFF;
+        break;
+    case SSD1351_CMD_ALL_ON:
+        emu.mode = EMU_MODE_ALL_ON;
+        break;
+    case SSD1351_CMD_NORMAL:
+        emu.mode = EMU_MODE_NORMAL;
+        break;
+    case SSD1351_CMD_INVERSE:
+        emu.mode = EMU_MODE_INVERSE;
+        break;
+    case SSD1351_CMD_DISPLAY_OFF:
+        emu.on = 0;
+        break;
+    case SSD1351_CMD_DISPLAY_ON:
+        emu.on = 1;
+        break;
+    case SSD1351_CMD_LINEAR_GRAY:
+        emu.levels.linear = 1;
+        break;
+    default:
+        break;
+    }
+}
+
+/******************************************************************************
+* function: emu_argument
+* brief: Collect an argument byte and apply the command once it is complete
+******************************************************************************/
+static void emu_argument(uint8_t value)
+{
+    if (emu.nargs < EMU_MAX_ARGS)
+    {
+        emu.args[emu.nargs] = value;
+    }
+    emu.nargs++;
+
+    switch (emu.cmd)
+    {
+    case SSD1351_CMD_SET_COLUMN:
+        if (emu.nargs == 2)
+        {
+            emu.col0 = emu.args[0] & 0x7F;
+            emu.col1 = emu.args[1] & 0x7F;
+            emu.col = emu.col0;
+        }
+        break;
+    case SSD1351_CMD_SET_ROW:
+        if (emu.nargs == 2)
+        {
+            emu.row0 = emu.args[0] & 0x7F;
+            emu.row1 = emu.args[1] & 0x7F;
+            emu.row = emu.row0;
+        }
+        break;
+    case SSD1351_CMD_SET_REMAP:
+        if (emu.nargs == 1)
+        {
+            emu.remap = value;
+        }
+        break;
+    case SSD1351_CMD_START_LINE:
+        if (emu.nargs == 1)
+        {
+            emu.start_line = value & 0x7F;
+        }
+        break;
+    case SSD1351_CMD_OFFSET:
+        if (emu.nargs == 1)
+        {
+            emu.offset = value & 0x7F;
+        }
+        break;
+    case SSD1351_CMD_LOCK:
+        if (emu.nargs == 1 && (value == SSD1351_UNLOCK || value == SSD1351_LOCK))
+        {
+            emu.locked = (value == SSD1351_LOCK);
+        }
+        else if (emu.nargs == 1 && (value == SSD1351_RESTRICTED_OFF || value == SSD1351_RESTRICTED_ON))
+        {
+            emu.restricted = (value == SSD1351_RESTRICTED_OFF);
+        }
+        break;
+    case SSD1351_CMD_GRAY_TABLE:
+        if (emu.nargs == SSD1351_GRAY_LEVELS)
+        {
+            memcpy(emu.levels.gray_table, emu.args, SSD1351_GRAY_LEVELS);
+            emu.levels.linear = 0;
+        }
+        break;
+    case SSD1351_CMD_CONTRAST:
+        if (emu.nargs == 3)
+        {
+            memcpy(emu.levels.contrast, emu.args, 3);
+        }
+        break;
+    case SSD1351_CMD_MASTER:
+        if (emu.nargs == 1)
+        {
+            emu.levels.master = value & 0x0F;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/******************************************************************************
+* function: emu_pixel_byte
+* brief: Store a GDDRAM byte and advance the write pointer after each pixel
+******************************************************************************/
+static void emu_pixel_byte(uint8_t value)
+{
+    emu.gddram[emu.row * SSD1351_PITCH + emu.col * 2 + emu.half] = value;
+    emu.stats.pixel_bytes++;
+    if (++emu.half < 2)
+    {
+        return;
+    }
+    emu.half = 0;
+
+    // The pointer wraps within the window, in the order the remap selects
+    if (emu.remap & SSD1351_REMAP_VERTICAL)
+    {
+        if (++emu.row > emu.row1)
+        {
+            emu.row = emu.row0;
+            if (++emu.col > emu.col1)
+            {
+                emu.col = emu.col0;
+            }
+        }
+    }
+    else
+    {
+        if (++emu.col > emu.col1)
+        {
+            emu.col = emu.col0;
+            if (++emu.row > emu.row1)
+            {
+                emu.row = emu.row0;
+            }
+        }
+    }
+}
+
+/******************************************************************************
+* function: emu_bus_time
+* brief: Hold the writer until the simulated bus has sent a block
+******************************************************************************/
+static void emu_bus_time(size_t len)
+{
+    uint32_t spi_hz = emu.spi_hz;
+    uint64_t ns = emu.call_ns;
+    struct timespec now;
+
+    if (spi_hz == 0 && ns == 0)
+    {
+        return;
+    }
+
+    if (spi_hz != 0)
+    {
+        ns += (uint64_t)len * 8 * 1000000000ULL / spi_hz;
+    }
+
+    // The bus picks the block up when it is idle, or now if it has been
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (emu.bus_free.tv_sec < now.tv_sec ||
+        (emu.bus_free.tv_sec == now.tv_sec && emu.bus_free.tv_nsec < now.tv_nsec))
+    {
+        emu.bus_free = now;
+    }
+    emu.bus_free.tv_sec += ns / 1000000000ULL;
+    emu.bus_free.tv_nsec += ns % 1000000000ULL;
+    if (emu.bus_free.tv_nsec >= 1000000000L)
+    {
+        emu.bus_free.tv_sec++;
+        emu.bus_free.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&emu.lock);
+    emu.stats.busy_ns += ns;
+    pthread_mutex_unlock(&emu.lock);
+
+    int64_t ahead = (int64_t)(emu.bus_free.tv_sec - now.tv_sec) * 1000000000LL
+                  + (emu.bus_free.tv_nsec - now.tv_nsec);
+    if (ahead < EMU_SLEEP_SLACK_NS)
+    {
+        return;
+    }
+
+    // An absolute deadline survives signals: just sleep again
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &emu.bus_free, NULL) == EINTR)
+    {
+    }
+}
+
+/******************************************************************************
+* function: ssd1351_emu_write
+* brief: Feed a command or data block to the emulated controller
+******************************************************************************/
+void ssd1351_emu_write(int dc, const uint8_t *data, size_t len)
+{
+    pthread_mutex_lock(&emu.lock);
+    emu.stats.bytes += len;
+    emu.stats.transfers++;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (!dc)
+        {
+            emu_command(data[i]);
+        }
+        else if (emu.cmd == SSD1351_CMD_WRITE_RAM)
+        {
+            emu_pixel_byte(data[i]);
+        }
+        else if (emu.cmd != 0)
+        {
+            emu_argument(data[i]);
+        }
+    }
+    pthread_mutex_unlock(&emu.lock);
+
+    emu_bus_time(len);
+}
+
+void ssd1351_emu_read_gddram(uint8_t *frame)
+{
+    pthread_mutex_lock(&emu.lock);
+    memcpy(frame, emu.gddram, SSD1351_FRAME_BYTES);
+    pthread_mutex_unlock(&emu.lock);
+}
+
+/******************************************************************************
+* function: ssd1351_emu_read_screen
+* brief: Render what the panel shows
+*
+* The panel is mounted like the Waveshare module: with the COM scan
+* reversed RAM row 0 is the top line, and with the C-B-A sequence the
+* RGB565 fields reach the red and blue subpixels as sent. Start line and
+* offset both shift the picture up, wrapping around.
+******************************************************************************/
+void ssd1351_emu_read_screen(uint8_t *frame)
+{
+    pthread_mutex_lock(&emu.lock);
+    for (int y = 0; y < SSD1351_HEIGHT; y++)
+    {
+        int line = (emu.remap & SSD1351_REMAP_COM_REVERSE) ? y : SSD1351_HEIGHT - 1 - y;
+        int row = (line + emu.start_line + emu.offset) % SSD1351_HEIGHT;
+
+        for (int x = 0; x < SSD1351_WIDTH; x++)
+        {
+            int col = (emu.remap & SSD1351_REMAP_COLUMN) ? SSD1351_WIDTH - 1 - x : x;
+            const uint8_t *p = emu.gddram + row * SSD1351_PITCH + col * 2;
+            uint16_t pixel = (uint16_t)((p[0] << 8) | p[1]);
+
+            if (!(emu.remap & SSD1351_REMAP_CBA))
+            {
+                // A-B-C order: the red and blue fields change places
+                pixel = (uint16_t)((pixel >> 11) | (pixel & 0x07E0) | (pixel << 11));
+            }
+            if (!emu.on || emu.mode == EMU_MODE_ALL_OFF)
+            {
+                pixel = 0;
+            }
+            else if (emu.mode == EMU_MODE_ALL_ON)
+            {
+                pixel = 0xFFFF;
+            }
+            else if (emu.mode == EMU_MODE_INVERSE)
+            {
+                pixel = (uint16_t)~pixel;
+            }
+
+            frame[(y * SSD1351_WIDTH + x) * 2] = (uint8_t)(pixel >> 8);
+            frame[(y * SSD1351_WIDTH + x) * 2 + 1] = (uint8_t)pixel;
+        }
+    }
+    pthread_mutex_unlock(&emu.lock);
+}
+
+void ssd1351_emu_get_levels(ssd1351_emu_levels *levels)
+{
+    pthread_mutex_lock(&emu.lock);
+    *levels = emu.levels;
+    pthread_mutex_unlock(&emu.lock);
+}
+
+void ssd1351_emu_get_stats(ssd1351_emu_stats *stats)
+{
+    pthread_mutex_lock(&emu.lock);
+    *stats = emu.stats;
+    pthread_mutex_unlock(&emu.lock);
+}
+
+/******************************************************************************
+* function: emu_backend_init
+* brief: Reset the model, route the ssd1351 commands to it and initialize it
+*
+* Sends the part of the Waveshare init sequence the model decodes, so the
+* panel ends up in the same orientation, color order and drive levels.
+******************************************************************************/
+static int emu_backend_init(void)
+{
+    const uint8_t unlock = SSD1351_UNLOCK;
+    const uint8_t restricted_on = SSD1351_RESTRICTED_ON;
+    const uint8_t remap = SSD1351_EMU_REMAP;
+    const uint8_t zero = 0x00;
+    const uint8_t contrast[3] = { 0xC8, 0x80, 0xC0 };
+    const uint8_t master = SSD1351_MASTER_MAX;
+
+    ssd1351_emu_reset();
+    ssd1351_set_bus(ssd1351_emu_write);
+
+    ssd1351_command(SSD1351_CMD_LOCK, &unlock, 1);
+    ssd1351_command(SSD1351_CMD_LOCK, &restricted_on, 1);
+    ssd1351_command(SSD1351_CMD_DISPLAY_OFF, NULL, 0);
+    ssd1351_command(SSD1351_CMD_SET_REMAP, &remap, 1);
+    ssd1351_command(SSD1351_CMD_START_LINE, &zero, 1);
+    ssd1351_command(SSD1351_CMD_OFFSET, &zero, 1);
+    ssd1351_command(SSD1351_CMD_CONTRAST, contrast, 3);
+    ssd1351_command(SSD1351_CMD_MASTER, &master, 1);
+    ssd1351_command(SSD1351_CMD_NORMAL, NULL, 0);
+    ssd1351_command(SSD1351_CMD_DISPLAY_ON, NULL, 0);
+    return 0;
+}
+
+static void emu_backend_clear(void)
+{
+    static const uint8_t black[SSD1351_FRAME_BYTES];
+
+    ssd1351_write_frame(black);
+}
+
+static void emu_backend_display(const uint8_t *frame, const uint8_t *prev)
+{
+    ssd1351_write_changes(frame, prev);
+}
+
+static void emu_backend_display_field(const uint8_t *frame, const uint8_t *prev, int field)
+{
+    ssd1351_write_field(frame, prev, field);
+}
+
+static void emu_backend_set_spi_clock(uint32_t hz)
+{
+    emu.spi_hz = hz;
+}
+
+static void emu_backend_set_levels(const display_levels *levels)
+{
+    uint8_t table[SSD1351_GRAY_LEVELS];
+
+    if (levels->gamma > 0.0)
+    {
+        ssd1351_gamma_table(levels->gamma, table);
+    }
+    ssd1351_set_levels((levels->gamma > 0.0) ? table : NULL, levels->contrast, levels->master);
+}
+
+static void emu_backend_exit(void)
+{
+    ssd1351_set_bus(NULL);
+}
+
+const display_backend display_backend_emu =
+{
+    .name = "ssd1351-emu",
+    .init = emu_backend_init,
+    .clear = emu_backend_clear,
+    .display = emu_backend_display,
+    .display_field = emu_backend_display_field,
+    .set_spi_clock = emu_backend_set_spi_clock,
+    .set_levels = emu_backend_set_levels,
+    .exit = emu_backend_exit,
+};
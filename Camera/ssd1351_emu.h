@@ -0,0 +1,126 @@
+/******************************************************************************
+* SSD1351_EMU.H
+*
+* This header file defines a software model of the SSD1351 OLED controller,
+* fed with the same command and data bytes the panel would receive. It
+* provides functions for:
+*   - Decoding commands: column/row windows, RAM writes, remap and color
+*     order, start line and offset, display modes and the command lock
+*   - Reading back the GDDRAM and the picture the panel would show
+*   - Simulating the time the bytes take on an SPI bus of a given clock
+*   - Counting bytes, commands, transfers and simulated bus time
+*
+* Used through display_backend_emu (display_backend.h), the camera driver
+* runs unchanged on a machine without the panel, and the statistics give
+* the throughput and latency of the whole pipeline at a chosen SPI clock.
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+*
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#ifndef SSD1351_EMU_H
+#define SSD1351_EMU_H
+
+#include <stdint.h>             // for uint8_t (8-bit unsigned integer)
+#include <stddef.h>             // defines size_t
+#include "ssd1351.h"            // SSD1351_GRAY_LEVELS
+
+// Remap/color depth register (SSD1351_CMD_SET_REMAP) bits
+#define SSD1351_REMAP_VERTICAL      0x01    // vertical address increment
+#define SSD1351_REMAP_COLUMN        0x02    // column address 0 on the right
+#define SSD1351_REMAP_CBA           0x04    // C-B-A color sequence
+#define SSD1351_REMAP_COM_REVERSE   0x10    // COM scan from the last row
+#define SSD1351_REMAP_SPLIT         0x20    // odd/even COM split
+#define SSD1351_REMAP_DEPTH         0xC0    // color depth (00/01 = 65k)
+
+// Remap of the Waveshare init sequence (65k colors, COM split, C-B-A,
+// reversed COM scan). The emulated panel is mounted like the Waveshare
+// module, so with this setting frames appear upright and in their colors.
+#define SSD1351_EMU_REMAP 0x74
+
+// Default simulated SPI clock
+#define SSD1351_EMU_SPI_HZ 20000000
+
+// Drive level registers as programmed
+typedef struct
+{
+    int linear;                 // built-in linear gray scale table in use
+    uint8_t gray_table[SSD1351_GRAY_LEVELS];     // GS1-GS63 pulse widths, if not linear
+    uint8_t contrast[3];        // contrast current of colors A, B, C
+    uint8_t master;             // master current step
+} ssd1351_emu_levels;
+
+// Bus statistics since the last ssd1351_emu_reset
+typedef struct
+{
+    uint64_t bytes;             // all bytes on the bus
+    uint64_t pixel_bytes;       // bytes written to GDDRAM
+    uint64_t commands;          // command bytes
+    uint64_t transfers;         // command and data blocks (DC/CS setups)
+    uint64_t windows;           // RAM writes started
+    uint64_t busy_ns;           // simulated bus time
+} ssd1351_emu_stats;
+
+/******************************************************************************
+ * Reset the emulated controller: black GDDRAM, full window, remap 0,
+ * display off, unlocked with the restricted commands locked, and the
+ * default drive levels. Statistics are cleared; the timing is kept.
+ *******************************************************************************/
+void ssd1351_emu_reset(void);
+
+/******************************************************************************
+ * Set the simulated bus timing.
+ *
+ * Every block costs call_ns plus 8 bits per byte at spi_hz, and
+ * ssd1351_emu_write returns only once the simulated bus is done with it,
+ * like a blocking SPI write.
+ *
+ * param spi_hz - SPI clock, 0 for an infinitely fast bus
+ * param call_ns - fixed cost of each block (DC/CS setup, system call)
+ *******************************************************************************/
+void ssd1351_emu_set_timing(uint32_t spi_hz, uint32_t call_ns);
+
+/******************************************************************************
+ * Feed a command (dc 0) or data (dc 1) block to the controller; an
+ * ssd1351_bus_fn for ssd1351_set_bus.
+ *******************************************************************************/
+void ssd1351_emu_write(int dc, const uint8_t *data, size_t len);
+
+/******************************************************************************
+ * Copy the GDDRAM, row by row in RAM address order, as written.
+ *
+ * param frame - receives SSD1351_FRAME_BYTES bytes
+ *******************************************************************************/
+void ssd1351_emu_read_gddram(uint8_t *frame);
+
+/******************************************************************************
+ * Render what the panel shows: GDDRAM through remap, start line, offset,
+ * color order and display mode, as big-endian RGB565 top row first.
+ *
+ * param frame - receives SSD1351_FRAME_BYTES bytes
+ *******************************************************************************/
+void ssd1351_emu_read_screen(uint8_t *frame);
+
+/******************************************************************************
+ * Copy the drive level registers (gray scale table, contrast and master
+ * current).
+ *******************************************************************************/
+void ssd1351_emu_get_levels(ssd1351_emu_levels *levels);
+
+/******************************************************************************
+ * Copy the bus statistics.
+ *******************************************************************************/
+void ssd1351_emu_get_stats(ssd1351_emu_stats *stats);
+
+#endif /* SSD1351_EMU_H */
@@ -0,0 +1,542 @@
+/******************************************************************************
+* SSD1351_EMU_CHECK.C
+*
+* Checks of the panel update paths against the emulated SSD1351, runnable
+* on any machine without the panel. The updates are sent through the
+* emulator backend and the emulated GDDRAM is read back after each one, so
+* a wrong window, a missed row or a stale pixel shows up as a mismatch.
+* Each check prints the bytes it sent, which is what the partial updates
+* are meant to save. The present thread is checked through cam_driver
+* with a simulated bus, which also shows how much of the conversion hides
+* behind the transfers, and so is the interlaced mode, whose copy of the
+* panel contents must stay right for the whole-frame updates that follow.
+* The drive level presets are read back from the emulated registers.
+*
+* main_emu_check is an entry point like main_two and main_bench; it
+* returns non-zero if any check fails.
+*
+* Dependencies:
+*   - ssd1351.h - the update paths under test
+*   - ssd1351_emu.h - emulated controller and its GDDRAM
+*   - display_backend.h - emulator backend
+*   - cam_driver.h - present thread, through display_rgb565_frame
+*   - display_shm.h - mirror of the shown frames, read back
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "ssd1351.h"
+#include "ssd1351_emu.h"
+#include "display_backend.h"
+#include "cam_driver.h"
+#include "display_shm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CHECK_PITCH (SSD1351_WIDTH * 2)
+
+// Present thread check: 1080p sources scaled to the panel, over a bus at
+// 30 ns per byte (about 1 ms per full frame)
+#define CHECK_SRC_WIDTH  1920
+#define CHECK_SRC_HEIGHT 1080
+#define CHECK_SOURCES    4
+#define CHECK_FRAMES     60
+#define CHECK_SPI_HZ     266666667
+
+// Interlaced check: a short panel-sized file played at 30 FPS over an
+// 8 MHz bus, where a whole frame takes about 33 ms and a field about half
+#define CHECK_FILE_FRAMES 5
+#define CHECK_FILE_FPS    30
+#define CHECK_FILE_MS     700
+#define CHECK_FIELD_HZ    8000000
+#define CHECK_IDLE_MS     50
+
+static uint8_t panel[SSD1351_FRAME_BYTES];      // frame the panel shows
+static uint8_t next[SSD1351_FRAME_BYTES];       // frame to send
+static uint8_t gddram[SSD1351_FRAME_BYTES];
+static uint32_t noise_state = 1;
+static int failures = 0;
+
+static uint8_t noise_byte(void)
+{
+    noise_state = noise_state * 1103515245u + 12345u;
+    return (uint8_t)(noise_state >> 16);
+}
+
+/******************************************************************************
+* function: fill_rect
+* brief: Fill an area of a frame with one RGB565 color
+******************************************************************************/
+static void fill_rect(uint8_t *frame, int x, int y, int width, int height, uint16_t color)
+{
+    for (int row = y; row < y + height; row++)
+    {
+        for (int col = x; col < x + width; col++)
+        {
+            frame[row * CHECK_PITCH + col * 2] = (uint8_t)(color >> 8);
+            frame[row * CHECK_PITCH + col * 2 + 1] = (uint8_t)color;
+        }
+    }
+}
+
+static void fill_noise(uint8_t *frame)
+{
+    for (int i = 0; i < SSD1351_FRAME_BYTES; i++)
+    {
+        frame[i] = noise_byte();
+    }
+}
+
+/******************************************************************************
+* function: send_changes
+* brief: Update the emulated panel from 'panel' to 'next' and compare the
+*        GDDRAM with 'next'
+*
+* Parameters:
+*   name - what changed, for the report
+*   known - 0 to send as if the panel content were unknown
+******************************************************************************/
+static void send_changes(const char *name, int known)
+{
+    ssd1351_emu_stats before, after;
+
+    ssd1351_emu_get_stats(&before);
+    size_t sent = ssd1351_write_changes(next, known ? panel : NULL);
+    ssd1351_emu_get_stats(&after);
+    ssd1351_emu_read_gddram(gddram);
+
+    int match = (memcmp(gddram, next, SSD1351_FRAME_BYTES) == 0);
+    printf("  %-18s %6zu pixel bytes %6llu bus bytes %3llu windows  %s\n", name, sent,
+           (unsigned long long)(after.bytes - before.bytes),
+           (unsigned long long)(after.windows - before.windows), match ? "ok" : "GDDRAM MISMATCH");
+    if (!match)
+    {
+        failures++;
+    }
+    memcpy(panel, next, SSD1351_FRAME_BYTES);
+}
+
+/******************************************************************************
+* function: check_partial_updates
+* brief: Whole, unchanged, text-field and video updates through
+*        ssd1351_write_changes
+******************************************************************************/
+static void check_partial_updates(void)
+{
+    printf("Partial updates (ssd1351_write_changes):\n");
+
+    // A HUD-like screen: dark background, a few lighter fields
+    memset(next, 0, sizeof(next));
+    fill_rect(next, 4, 4, 120, 16, 0x39E7);
+    fill_rect(next, 4, 100, 56, 20, 0x07E0);
+    send_changes("unknown panel", 0);
+
+    send_changes("unchanged", 1);
+
+    // A changed text field: a distance reading
+    fill_rect(next, 8, 104, 40, 8, 0xFFFF);
+    send_changes("text field", 1);
+
+    // The field back as it was
+    fill_rect(next, 8, 104, 40, 8, 0x07E0);
+    send_changes("text field back", 1);
+
+    // Live video: every pixel changes
+    fill_noise(next);
+    send_changes("video frame", 1);
+}
+
+static void expect(const char *name, int ok)
+{
+    printf("  %-18s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+/******************************************************************************
+* function: check_tiles
+* brief: Tile masks, separate rectangles for fields on the same rows, and
+*        scattered single pixels
+******************************************************************************/
+static void check_tiles(void)
+{
+    ssd1351_rect rects[SSD1351_TILES_X * SSD1351_TILES_Y];
+
+    printf("Tile change detection (ssd1351_dirty_tiles, ssd1351_dirty_rects):\n");
+
+    memset(next, 0, sizeof(next));
+    send_changes("blank panel", 0);
+    expect("no changed tile", ssd1351_dirty_tiles(next, panel) == 0);
+
+    // A field inside tiles (0..2, 6)
+    fill_rect(next, 8, 104, 40, 8, 0xFFFF);
+    expect("tile mask", ssd1351_dirty_tiles(next, panel) ==
+           (SSD1351_TILE_BIT(0, 6) | SSD1351_TILE_BIT(1, 6) | SSD1351_TILE_BIT(2, 6)));
+    send_changes("field in 3 tiles", 1);
+
+    // Battery and distance: same rows, opposite sides of the panel
+    fill_rect(next, 4, 4, 24, 8, 0x07E0);
+    fill_rect(next, 96, 4, 28, 8, 0xF800);
+    int count = ssd1351_dirty_rects(next, panel, rects, SSD1351_TILES_X * SSD1351_TILES_Y);
+    expect("2 separate rects", count == 2);
+    send_changes("fields on one row", 1);
+
+    // Single pixels all over the panel
+    for (int i = 0; i < 24; i++)
+    {
+        int x = noise_byte() % SSD1351_WIDTH;
+        int y = noise_byte() % SSD1351_HEIGHT;
+        fill_rect(next, x, y, 1, 1, 0xFFFF);
+    }
+    send_changes("speckle", 1);
+
+    send_changes("unchanged", 1);
+}
+
+static uint64_t check_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+/******************************************************************************
+* function: check_present_thread
+* brief: Convert and present frames through cam_driver's present thread
+*
+* Every frame is different, so each one is a full transfer. Converting
+* and then sending each frame in turn would take the conversion plus the
+* bus time; with the present thread the two overlap, and a frame costs
+* about the slower of them. The panel must end up showing the last frame.
+******************************************************************************/
+static void check_present_thread(void)
+{
+    size_t source_bytes = yuv_frame_size(YUV_FORMAT_I420, CHECK_SRC_WIDTH, CHECK_SRC_HEIGHT);
+    const yuv_rect crop = { 0, 0, CHECK_SRC_WIDTH, CHECK_SRC_HEIGHT };
+    uint8_t *sources[CHECK_SOURCES];
+    ssd1351_emu_stats before, after;
+    uint64_t convert_ns = 0;
+
+    printf("Present thread (cam_driver, %dx%d sources, %u Hz bus):\n",
+           CHECK_SRC_WIDTH, CHECK_SRC_HEIGHT, (unsigned)CHECK_SPI_HZ);
+
+    for (int i = 0; i < CHECK_SOURCES; i++)
+    {
+        sources[i] = malloc(source_bytes);
+        if (sources[i] == NULL)
+        {
+            perror("Failed to allocate source frame");
+            while (i-- > 0)
+            {
+                free(sources[i]);
+            }
+            failures++;
+            return;
+        }
+        for (size_t k = 0; k < source_bytes; k++)
+        {
+            sources[i][k] = noise_byte();
+        }
+    }
+
+    if (set_display_backend(&display_backend_emu) != 0 ||
+        set_display_spi_clock(CHECK_SPI_HZ) != 0 || oled_init() != 0)
+    {
+        expect("emulator display", 0);
+    }
+    else
+    {
+        ssd1351_emu_get_stats(&before);
+        uint64_t start_ns = check_ns();
+        for (int i = 0; i < CHECK_FRAMES; i++)
+        {
+            uint64_t convert_start = check_ns();
+            yuv_frame_scale_to_rgb565(sources[i % CHECK_SOURCES], YUV_FORMAT_I420,
+                                      CHECK_SRC_WIDTH, CHECK_SRC_HEIGHT, &crop,
+                                      next, SSD1351_WIDTH, SSD1351_HEIGHT);
+            convert_ns += check_ns() - convert_start;
+            display_rgb565_frame(next);
+        }
+        // Drains the queue before the panel goes down
+        oled_cleanup();
+        uint64_t total_ns = check_ns() - start_ns;
+        ssd1351_emu_get_stats(&after);
+
+        double convert_ms = convert_ns / 1e6 / CHECK_FRAMES;
+        double bus_ms = (after.busy_ns - before.busy_ns) / 1e6 / CHECK_FRAMES;
+        printf("  convert %.2f ms + bus %.2f ms = %.2f ms per frame in turn, %.2f ms with the present thread\n",
+               convert_ms, bus_ms, convert_ms + bus_ms, total_ns / 1e6 / CHECK_FRAMES);
+
+        ssd1351_emu_read_gddram(gddram);
+        expect("last frame shown", memcmp(gddram, next, SSD1351_FRAME_BYTES) == 0);
+    }
+    set_display_backend(&display_backend_oled);
+
+    for (int i = 0; i < CHECK_SOURCES; i++)
+    {
+        free(sources[i]);
+    }
+}
+
+/******************************************************************************
+* function: write_check_file
+* brief: Write a short panel-sized I420 file: one frame repeated, then
+*        the same frame with another bottom half
+*
+* Played in a loop, the changed frame is shown once every CHECK_FILE_FRAMES
+* frames. The count is odd, so it lands on both fields in turn.
+*
+* returns 0 on success, -1 on failure
+******************************************************************************/
+static int write_check_file(char *path)
+{
+    size_t frame_bytes = yuv_frame_size(YUV_FORMAT_I420, SSD1351_WIDTH, SSD1351_HEIGHT);
+    size_t luma_bytes = (size_t)SSD1351_WIDTH * SSD1351_HEIGHT;
+    int fd = mkstemp(path);
+
+    if (fd < 0)
+    {
+        perror("Failed to create check file");
+        return -1;
+    }
+
+    fill_noise(next);
+    for (int i = 0; i < CHECK_FILE_FRAMES; i++)
+    {
+        uint8_t frame[yuv_frame_size(YUV_FORMAT_I420, SSD1351_WIDTH, SSD1351_HEIGHT)];
+
+        memcpy(frame, next, frame_bytes);
+        for (size_t k = luma_bytes / 2; i == CHECK_FILE_FRAMES - 1 && k < luma_bytes; k++)
+        {
+            frame[k] = noise_byte();
+        }
+        if (write(fd, frame, frame_bytes) != (ssize_t)frame_bytes)
+        {
+            perror("Failed to write check file");
+            close(fd);
+            unlink(path);
+            return -1;
+        }
+    }
+    close(fd);
+    return 0;
+}
+
+/******************************************************************************
+* function: wait_for_bus_idle
+* brief: Wait until the present thread has sent the frames still queued
+******************************************************************************/
+static void wait_for_bus_idle(void)
+{
+    ssd1351_emu_stats before, after;
+
+    ssd1351_emu_get_stats(&after);
+    do
+    {
+        before = after;
+        usleep(CHECK_IDLE_MS * 1000);
+        ssd1351_emu_get_stats(&after);
+    } while (after.bytes != before.bytes);
+}
+
+/******************************************************************************
+* function: shm_shows
+* brief: Whether the shared-memory mirror shows the given frame
+******************************************************************************/
+static int shm_shows(const display_shm_header *shm, const uint8_t *frame)
+{
+    uint8_t mirrored[SSD1351_FRAME_BYTES];
+    int same = (display_shm_read(shm, mirrored, NULL, NULL) == 0);
+
+    for (int y = 0; same && y < SSD1351_HEIGHT; y++)
+    {
+        same = (memcmp(mirrored + y * shm->stride, frame + y * CHECK_PITCH, CHECK_PITCH) == 0);
+    }
+    return same;
+}
+
+/******************************************************************************
+* function: check_interlaced
+* brief: Play a file in interlaced mode, then send a whole frame
+*
+* Each update is diffed against the driver's copy of the panel, so a copy
+* the field updates got wrong skips rows that differ from the panel when
+* the file's repeated frame comes back. The frames left in the queue by
+* stop_display go out whole; the panel and the shared-memory mirror must
+* then show the same. The whole frame sent last is what the panel shows
+* with one row changed, so only the band around that row may go out.
+******************************************************************************/
+static void check_interlaced(void)
+{
+    char path[] = "/tmp/emu_check_XXXXXX";
+    const display_shm_header *shm = NULL;
+    ssd1351_emu_stats before, after;
+
+    printf("Interlaced updates (%dx%d file at %d FPS, %u Hz bus):\n",
+           SSD1351_WIDTH, SSD1351_HEIGHT, CHECK_FILE_FPS, (unsigned)CHECK_FIELD_HZ);
+
+    if (write_check_file(path) != 0)
+    {
+        failures++;
+        return;
+    }
+
+    if (set_display_backend(&display_backend_emu) != 0 ||
+        set_display_mirror(&display_backend_shm) != 0 ||
+        set_display_spi_clock(CHECK_FIELD_HZ) != 0 ||
+        set_stream_size(SSD1351_WIDTH, SSD1351_HEIGHT) != 0 || oled_init() != 0)
+    {
+        expect("emulator display", 0);
+    }
+    else
+    {
+        shm = display_shm_attach(DISPLAY_SHM_NAME);
+        set_display_interlaced(1);
+
+        ssd1351_emu_get_stats(&before);
+        if (start_video_display(path, CHECK_FILE_FPS) == 0)
+        {
+            usleep(CHECK_FILE_MS * 1000);
+            stop_display();
+        }
+        wait_for_bus_idle();
+        ssd1351_emu_get_stats(&after);
+
+        frame_sched_stats sched;
+        uint64_t frames = (get_frame_sched_stats(&sched) == 0) ? sched.frames : 0;
+        printf("  %llu frames played, %llu bus bytes and %llu windows per frame\n",
+               (unsigned long long)frames,
+               (unsigned long long)(frames ? (after.bytes - before.bytes) / frames : 0),
+               (unsigned long long)(frames ? (after.windows - before.windows) / frames : 0));
+        expect("fields sent", frames > 0 && after.bytes - before.bytes < frames * SSD1351_FRAME_BYTES);
+
+        ssd1351_emu_read_gddram(panel);
+        expect("shm mirror after stop", shm != NULL && shm_shows(shm, panel));
+
+        // No stream runs, so this one goes out whole, diffed against the copy
+        memcpy(next, panel, SSD1351_FRAME_BYTES);
+        for (int x = 0; x < CHECK_PITCH; x++)
+        {
+            next[x] = (uint8_t)~next[x];
+        }
+        ssd1351_emu_get_stats(&before);
+        display_rgb565_frame(next);
+        oled_cleanup();
+        ssd1351_emu_get_stats(&after);
+
+        printf("  whole frame after: %llu pixel bytes\n",
+               (unsigned long long)(after.pixel_bytes - before.pixel_bytes));
+        expect("only the changed band", after.pixel_bytes - before.pixel_bytes <= SSD1351_TILE * CHECK_PITCH);
+        ssd1351_emu_read_gddram(gddram);
+        expect("whole frame after", memcmp(gddram, next, SSD1351_FRAME_BYTES) == 0);
+        expect("shm mirror after frame", shm != NULL && shm_shows(shm, next));
+
+        if (shm != NULL)
+        {
+            display_shm_detach(shm);
+        }
+    }
+
+    set_display_interlaced(DISPLAY_INTERLACED);
+    set_stream_size(CAMERA_WIDTH, CAMERA_HEIGHT);
+    set_display_mirror(NULL);
+    set_display_backend(&display_backend_oled);
+    unlink(path);
+}
+
+/******************************************************************************
+* function: check_levels
+* brief: Drive level presets as the controller receives them, and levels
+*        set_display_levels must refuse
+******************************************************************************/
+static void check_levels(void)
+{
+    static const uint8_t night_contrast[3] = { 0x64, 0x40, 0x60 };
+    static const uint8_t day_contrast[3] = { 0xC8, 0x80, 0xC0 };
+    ssd1351_emu_levels levels;
+
+    printf("Drive levels (set_display_preset, set_display_levels):\n");
+
+    if (set_display_backend(&display_backend_emu) != 0 || oled_init() != 0)
+    {
+        expect("emulator display", 0);
+        set_display_backend(&display_backend_oled);
+        return;
+    }
+
+    expect("night preset", set_display_preset(DISPLAY_PRESET_NIGHT) == 0);
+    ssd1351_emu_get_levels(&levels);
+    int increasing = !levels.linear && levels.gray_table[0] >= 1;
+    for (int i = 1; increasing && i < SSD1351_GRAY_LEVELS; i++)
+    {
+        increasing = (levels.gray_table[i] > levels.gray_table[i - 1]);
+    }
+    printf("  night table %u..%u DCLKs, master %u\n", (unsigned)levels.gray_table[0],
+           (unsigned)levels.gray_table[SSD1351_GRAY_LEVELS - 1], (unsigned)levels.master);
+    expect("night gray table", increasing &&
+           levels.gray_table[SSD1351_GRAY_LEVELS - 1] <= SSD1351_GRAY_MAX_PULSE);
+    expect("night currents", memcmp(levels.contrast, night_contrast, 3) == 0 && levels.master == 3);
+
+    expect("day preset", set_display_preset(DISPLAY_PRESET_DAY) == 0);
+    ssd1351_emu_get_levels(&levels);
+    expect("day linear table", levels.linear);
+    expect("day currents", memcmp(levels.contrast, day_contrast, 3) == 0 &&
+           levels.master == SSD1351_MASTER_MAX);
+
+    display_levels nan_gamma = { .gamma = NAN, .contrast = { 0xC8, 0x80, 0xC0 }, .master = 15 };
+    expect("NULL refused", set_display_levels(NULL) == -1);
+    expect("NaN gamma refused", set_display_levels(&nan_gamma) == -1);
+    ssd1351_emu_get_levels(&levels);
+    expect("day levels kept", levels.linear && levels.master == SSD1351_MASTER_MAX);
+
+    oled_cleanup();
+    set_display_backend(&display_backend_oled);
+}
+
+/******************************************************************************
+* function: main_emu_check
+* brief: Entry point: run the update checks against the emulated SSD1351
+*
+* returns 0 if every check passed, 1 otherwise
+******************************************************************************/
+int main_emu_check(void)
+{
+    // An infinitely fast bus; the checks are about content and bytes
+    ssd1351_emu_set_timing(0, 0);
+    if (display_backend_emu.init() != 0)
+    {
+        fprintf(stderr, "Emulator backend init failed\n");
+        return 1;
+    }
+
+    check_partial_updates();
+    check_tiles();
+
+    display_backend_emu.exit();
+
+    // Brings the emulator backend up again through cam_driver
+    check_present_thread();
+    check_interlaced();
+    check_levels();
+
+    printf("SSD1351 emulator checks: %s\n", failures ? "FAILED" : "passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,802 @@
+/******************************************************************************
+* YUV_CONVERT.C
+*
+* Implementation of the colorspace conversion engine. This file contains the
+* reference YUV to RGB formula, the scalar row and 2x2 block kernels, and
+* the kernel and colorimetry selection used by display_camera_frame.
+*
+* Kernel selection happens once, before main, in a CPU feature probe: the
+* fastest kernel that is compiled in and supported by the host is chosen,
+* so the same binary runs the vector path on any machine.
+*
+* Every kernel exists once per colorimetry (BT.601/BT.709, limited/full
+* range) with the coefficients compiled in. The stream's colorimetry is set
+* once when it starts and only changes which variant the frame loop calls.
+*
+* The frame loop walks the planes two rows at a time and hands each row pair
+* to the active kernel's block entry point, so the U/V terms are computed
+* once per 2x2 block and each chroma row is read only once. Frames are split
+* into bands of whole row pairs and converted on the worker pool when it is
+* running (convert_pool.h), otherwise inline.
+*
+* NV12/NV21 and YUYV frames are described by a small format table. Their
+* interleaved samples are split one row at a time into stack scratch rows
+* (by the SIMD split helper that goes with the active kernel) and fed to
+* the same kernels, so every layout shares the vector code paths.
+*
+* In grayscale mode the bands hand only the luma rows to the gray kernel;
+* planar and semi-planar chroma is not read at all.
+*
+* Every band also counts the luma rows it has just converted into a
+* histogram (yuv_stats.c), which becomes the frame's luma statistics.
+*
+* Mirroring, flipping and rotation only change where the kernels write:
+* each row pair gets its output address and per-pixel step from a
+* yuv_output set up once per frame, so an oriented frame costs the same
+* memory traffic as an upright one.
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "yuv_convert.h"
+#include "yuv_kernels.h"
+#include "convert_pool.h"
+#include <stdio.h>
+
+// Kernel table entries: one row, pair and gray function per colorimetry
+#define KERNEL_ROW(family, name, ...)  yuv_row_##family##_##name,
+#define KERNEL_PAIR(family, name, ...) yuv_pair_##family##_##name,
+#define KERNEL_GRAY(family, name, ...) yuv_gray_##family##_##name,
+#define KERNEL_ENTRY(label, family, split, scale) \
+    { label, { YUV_COLORIMETRIES(KERNEL_ROW, family) }, { YUV_COLORIMETRIES(KERNEL_PAIR, family) }, \
+      { YUV_COLORIMETRIES(KERNEL_GRAY, family) }, \
+      yuv_split_uv_##split, yuv_split_yuyv_##split, yuv_scale_rows_##scale }
+
+// Kernel table, indexed by yuv_kernel_t and yuv_colorimetry_t (NULL when
+// not compiled in). Each kernel also names the deinterleave helpers used
+// in front of it for semi-planar and packed input, and the vertical pass
+// of the downscaler (yuv_scale.c).
+static const struct
+{
+    const char *name;
+    yuv_row_fn row[YUV_COLORIMETRY_COUNT];
+    yuv_pair_fn pair[YUV_COLORIMETRY_COUNT];
+    yuv_gray_fn gray[YUV_COLORIMETRY_COUNT];
+    yuv_split_uv_fn split_uv;
+    yuv_split_yuyv_fn split_yuyv;
+    yuv_scale_rows_fn scale_rows;
+} kernel_table[YUV_KERNEL_COUNT] =
+{
+    [YUV_KERNEL_SCALAR] = KERNEL_ENTRY("scalar", scalar, scalar, scalar),
+    [YUV_KERNEL_LUT]    = KERNEL_ENTRY("lut", lut, scalar, scalar),
+#ifdef YUV_HAVE_NEON
+    [YUV_KERNEL_NEON]   = KERNEL_ENTRY("neon", neon, neon, neon),
+#else
+    [YUV_KERNEL_NEON]   = { "neon", { NULL }, { NULL }, { NULL }, NULL, NULL, NULL },
+#endif
+#ifdef YUV_HAVE_X86
+    [YUV_KERNEL_SSE41]  = KERNEL_ENTRY("sse4.1", sse41, sse41, sse41),
+    [YUV_KERNEL_AVX2]   = KERNEL_ENTRY("avx2", avx2, sse41, avx2),
+#else
+    [YUV_KERNEL_SSE41]  = { "sse4.1", { NULL }, { NULL }, { NULL }, NULL, NULL, NULL },
+    [YUV_KERNEL_AVX2]   = { "avx2", { NULL }, { NULL }, { NULL }, NULL, NULL, NULL },
+#endif
+};
+
+static const char *const colorimetry_names[YUV_COLORIMETRY_COUNT] =
+{
+    [YUV_BT601_LIMITED] = "bt601-limited",
+    [YUV_BT601_FULL]    = "bt601-full",
+    [YUV_BT709_LIMITED] = "bt709-limited",
+    [YUV_BT709_FULL]    = "bt709-full",
+};
+
+static const char *const orientation_names[YUV_ORIENT_COUNT] =
+{
+    [YUV_ORIENT_NORMAL]     = "normal",
+    [YUV_ORIENT_MIRROR]     = "mirror",
+    [YUV_ORIENT_FLIP]       = "flip",
+    [YUV_ORIENT_ROTATE_180] = "rotate-180",
+    [YUV_ORIENT_TRANSPOSE]  = "transpose",
+    [YUV_ORIENT_ROTATE_90]  = "rotate-90",
+    [YUV_ORIENT_ROTATE_270] = "rotate-270",
+    [YUV_ORIENT_TRANSVERSE] = "transverse",
+};
+
+// yuv_orientation_t is laid out as bit flags: mirror the output rows,
+// flip the output columns, and swap the axes first
+#define ORIENT_MIRROR    1
+#define ORIENT_FLIP      2
+#define ORIENT_TRANSPOSE 4
+
+// Preferred kernels, fastest first; the probe picks the first usable one
+static const yuv_kernel_t kernel_preference[] =
+{
+    YUV_KERNEL_AVX2,
+    YUV_KERNEL_SSE41,
+    YUV_KERNEL_NEON,
+    YUV_KERNEL_LUT,
+    YUV_KERNEL_SCALAR,
+};
+
+// Set by the CPU probe; compiled-in NEON needs no runtime check
+static int kernel_supported[YUV_KERNEL_COUNT] =
+{
+    [YUV_KERNEL_SCALAR] = 1,
+    [YUV_KERNEL_LUT]    = 1,
+#ifdef YUV_HAVE_NEON
+    [YUV_KERNEL_NEON]   = 1,
+#endif
+};
+
+static yuv_kernel_t active_kernel = YUV_KERNEL_SCALAR;
+static yuv_colorimetry_t active_colorimetry = YUV_BT601_LIMITED;
+static yuv_orientation_t active_orientation = YUV_ORIENT_NORMAL;
+static int grayscale = 0;
+
+/******************************************************************************
+* function: yuv_convert_probe
+* brief: One-time CPU feature probe
+*
+* Runs before main (constructor) so every conversion, including the first
+* frame, uses the best kernel without the callers having to initialize
+* anything. Vector kernels that are compiled in but not supported by the
+* host CPU stay disabled.
+******************************************************************************/
+__attribute__((constructor))
+static void yuv_convert_probe(void)
+{
+#ifdef YUV_HAVE_X86
+    __builtin_cpu_init();
+    kernel_supported[YUV_KERNEL_SSE41] = __builtin_cpu_supports("sse4.1");
+    kernel_supported[YUV_KERNEL_AVX2] = __builtin_cpu_supports("avx2");
+#endif
+
+    for (size_t i = 0; i < sizeof(kernel_preference) / sizeof(kernel_preference[0]); i++)
+    {
+        if (yuv_kernel_available(kernel_preference[i]))
+        {
+            active_kernel = kernel_preference[i];
+            break;
+        }
+    }
+}
+
+/******************************************************************************
+* function: yuv420_to_rgb
+* brief: Convert YUV420 color space to RGB
+*
+* This function implements the standard YUV420 to RGB color conversion formula,
+* with proper clamping of values to ensure valid RGB output in the range [0-255].
+* It is the BT.601 limited-range reference the conversion kernels are
+* checked against.
+*
+* Parameters:
+*   y - Y component (luminance)
+*   u - U component (chrominance)
+*   v - V component (chrominance)
+*   r - Pointer to store resulting Red component
+*   g - Pointer to store resulting Green component
+*   b - Pointer to store resulting Blue component
+******************************************************************************/
+void yuv420_to_rgb(uint8_t y, uint8_t u, uint8_t v, uint8_t *r, uint8_t *g, uint8_t *b)
+{
+    // YUV to RGB conversion formula
+    int c = y - 16;
+    int d = u - 128;
+    int e = v - 128;
+
+    // Calculate RGB values
+    int r_temp = (298 * c + 409 * e + 128) >> 8;
+    int g_temp = (298 * c - 100 * d - 208 * e + 128) >> 8;
+    int b_temp = (298 * c + 516 * d + 128) >> 8;
+
+    // Clamp values to valid range [0, 255]
+    *r = (r_temp < 0) ? 0 : ((r_temp > 255) ? 255 : r_temp);
+    *g = (g_temp < 0) ? 0 : ((g_temp > 255) ? 255 : g_temp);
+    *b = (b_temp < 0) ? 0 : ((b_temp > 255) ? 255 : b_temp);
+}
+
+/******************************************************************************
+* function: block_pixel
+* brief: Convert one pixel from its luma sample and the precomputed chroma
+*        terms of its 2x2 block (or horizontal pair)
+******************************************************************************/
+YUV_INLINE void block_pixel(uint8_t *dst, uint8_t y, int r_uv, int g_uv, int b_uv, yuv_coeffs k)
+{
+    int c = k.y_gain * (y - k.y_offset);
+
+    yuv_put_rgb565(dst, yuv_clamp8((c + r_uv) >> 8),
+                        yuv_clamp8((c + g_uv) >> 8),
+                        yuv_clamp8((c + b_uv) >> 8));
+}
+
+/******************************************************************************
+* function: scalar_row
+* brief: Reference row kernel body
+*
+* Converts a row two pixels at a time so each U/V pair is loaded once, then
+* packs the result as big-endian RGB565. Used as the fallback on builds
+* without SIMD and for the tail of rows the vector kernels do not cover.
+******************************************************************************/
+YUV_INLINE void scalar_row(const uint8_t *y_row, const uint8_t *u_row,
+                           const uint8_t *v_row, uint8_t *dst, int width,
+                           ptrdiff_t step, yuv_coeffs k)
+{
+    for (int col = 0; col < width; col += 2)
+    {
+        int d = u_row[col >> 1] - 128;
+        int e = v_row[col >> 1] - 128;
+        int r_uv = k.r_v * e + 128;
+        int g_uv = k.g_u * d + k.g_v * e + 128;
+        int b_uv = k.b_u * d + 128;
+
+        block_pixel(dst,        y_row[col],     r_uv, g_uv, b_uv, k);
+        block_pixel(dst + step, y_row[col + 1], r_uv, g_uv, b_uv, k);
+        dst += 2 * step;
+    }
+}
+
+/******************************************************************************
+* function: scalar_pair
+* brief: 2x2 block kernel body
+*
+* Computes the U/V terms once per 2x2 block, applies them to the four luma
+* samples and writes both output rows in the same pass. Same formula and
+* output as yuv420_to_rgb, with 75% less chroma arithmetic and U/V loads.
+*
+* Parameters:
+*   y_row0, y_row1 - luma samples for the even and odd row
+*   u_row, v_row - shared chroma samples (width/2)
+*   dst0, dst1 - big-endian RGB565 output of the first pixel of each row
+*   width - number of pixels (even)
+*   step - byte offset between consecutive output pixels
+*   k - colorimetry coefficients (compile-time constants)
+******************************************************************************/
+YUV_INLINE void scalar_pair(const uint8_t *y_row0, const uint8_t *y_row1,
+                            const uint8_t *u_row, const uint8_t *v_row,
+                            uint8_t *dst0, uint8_t *dst1, int width,
+                            ptrdiff_t step, yuv_coeffs k)
+{
+    for (int col = 0; col < width; col += 2)
+    {
+        // Chroma terms shared by the 2x2 block (rounding folded in)
+        int d = u_row[col >> 1] - 128;
+        int e = v_row[col >> 1] - 128;
+        int r_uv = k.r_v * e + 128;
+        int g_uv = k.g_u * d + k.g_v * e + 128;
+        int b_uv = k.b_u * d + 128;
+
+        block_pixel(dst0,        y_row0[col],     r_uv, g_uv, b_uv, k);
+        block_pixel(dst0 + step, y_row0[col + 1], r_uv, g_uv, b_uv, k);
+        block_pixel(dst1,        y_row1[col],     r_uv, g_uv, b_uv, k);
+        block_pixel(dst1 + step, y_row1[col + 1], r_uv, g_uv, b_uv, k);
+
+        dst0 += 2 * step;
+        dst1 += 2 * step;
+    }
+}
+
+/******************************************************************************
+* function: scalar_gray
+* brief: Grayscale kernel body, the color formula with neutral chroma
+******************************************************************************/
+YUV_INLINE void scalar_gray(const uint8_t *y_row, uint8_t *dst, int width,
+                            ptrdiff_t step, yuv_coeffs k)
+{
+    for (int col = 0; col < width; col++)
+    {
+        uint8_t v = yuv_clamp8((k.y_gain * (y_row[col] - k.y_offset) + 128) >> 8);
+
+        yuv_put_rgb565(dst, v, v, v);
+        dst += step;
+    }
+}
+
+// yuv_row/pair/gray_scalar_<colorimetry>
+#define SCALAR_KERNELS(family, name, ...) \
+    void yuv_row_##family##_##name(const uint8_t *y_row, const uint8_t *u_row, \
+                                   const uint8_t *v_row, uint8_t *dst, int width, \
+                                   ptrdiff_t step) \
+    { \
+        scalar_row(y_row, u_row, v_row, dst, width, step, (yuv_coeffs){ __VA_ARGS__ }); \
+    } \
+    void yuv_pair_##family##_##name(const uint8_t *y_row0, const uint8_t *y_row1, \
+                                    const uint8_t *u_row, const uint8_t *v_row, \
+                                    uint8_t *dst0, uint8_t *dst1, int width, \
+                                    ptrdiff_t step) \
+    { \
+        scalar_pair(y_row0, y_row1, u_row, v_row, dst0, dst1, width, step, \
+                    (yuv_coeffs){ __VA_ARGS__ }); \
+    } \
+    void yuv_gray_##family##_##name(const uint8_t *y_row, uint8_t *dst, int width, \
+                                    ptrdiff_t step) \
+    { \
+        scalar_gray(y_row, dst, width, step, (yuv_coeffs){ __VA_ARGS__ }); \
+    }
+
+YUV_COLORIMETRIES(SCALAR_KERNELS, scalar)
+
+/******************************************************************************
+* function: yuv_split_uv_scalar
+* brief: Split interleaved chroma pairs into two rows
+******************************************************************************/
+void yuv_split_uv_scalar(const uint8_t *uv, uint8_t *first, uint8_t *second, int pairs)
+{
+    for (int i = 0; i < pairs; i++)
+    {
+        first[i] = uv[2 * i];
+        second[i] = uv[2 * i + 1];
+    }
+}
+
+/******************************************************************************
+* function: yuv_split_yuyv_scalar
+* brief: Split a packed YUYV row into Y, U and V rows
+******************************************************************************/
+void yuv_split_yuyv_scalar(const uint8_t *yuyv, uint8_t *y, uint8_t *u, uint8_t *v, int width)
+{
+    for (int i = 0; i < width / 2; i++)
+    {
+        y[2 * i] = yuyv[4 * i];
+        u[i] = yuyv[4 * i + 1];
+        y[2 * i + 1] = yuyv[4 * i + 2];
+        v[i] = yuyv[4 * i + 3];
+    }
+}
+
+/******************************************************************************
+* function: yuv_scale_rows_scalar
+* brief: Vertical downscaler pass, one weighted sum of 'taps' rows per byte
+******************************************************************************/
+void yuv_scale_rows_scalar(const uint8_t *const *rows, const uint16_t *weights,
+                           int taps, uint8_t *dst, int n)
+{
+    for (int x = 0; x < n; x++)
+    {
+        unsigned acc = 128;
+
+        for (int t = 0; t < taps; t++)
+        {
+            acc += weights[t] * rows[t][x];
+        }
+        dst[x] = acc >> 8;
+    }
+}
+
+/******************************************************************************
+* function: yuv_convert_select_kernel
+* brief: Select the conversion kernel used for frame conversion
+*
+* returns 0 on success, -1 if the kernel is not available in this build
+******************************************************************************/
+int yuv_convert_select_kernel(yuv_kernel_t kernel)
+{
+    if (!yuv_kernel_available(kernel))
+    {
+        fprintf(stderr, "Conversion kernel %s not available\n", yuv_kernel_name(kernel));
+        return -1;
+    }
+
+    active_kernel = kernel;
+    return 0;
+}
+
+/******************************************************************************
+* function: yuv_convert_set_colorimetry
+* brief: Select the matrix and range of the incoming stream
+*
+* Only changes which kernel variant the next frame picks up; frames already
+* being converted keep the variant they started with.
+*
+* returns 0 on success, -1 for an unknown colorimetry
+******************************************************************************/
+int yuv_convert_set_colorimetry(yuv_colorimetry_t colorimetry)
+{
+    if ((int)colorimetry < 0 || colorimetry >= YUV_COLORIMETRY_COUNT)
+    {
+        fprintf(stderr, "Unknown colorimetry %d\n", (int)colorimetry);
+        return -1;
+    }
+
+    active_colorimetry = colorimetry;
+    return 0;
+}
+
+yuv_colorimetry_t yuv_convert_colorimetry(void)
+{
+    return active_colorimetry;
+}
+
+const char *yuv_colorimetry_name(yuv_colorimetry_t colorimetry)
+{
+    if ((int)colorimetry < 0 || colorimetry >= YUV_COLORIMETRY_COUNT)
+    {
+        return "unknown";
+    }
+    return colorimetry_names[colorimetry];
+}
+
+/******************************************************************************
+* function: yuv_convert_set_orientation
+* brief: Select the orientation of the converted picture
+*
+* Like the colorimetry, it is picked up by the next frame, so it can be
+* changed while a stream is running.
+*
+* returns 0 on success, -1 for an unknown orientation
+******************************************************************************/
+int yuv_convert_set_orientation(yuv_orientation_t orientation)
+{
+    if ((int)orientation < 0 || orientation >= YUV_ORIENT_COUNT)
+    {
+        fprintf(stderr, "Unknown orientation %d\n", (int)orientation);
+        return -1;
+    }
+
+    active_orientation = orientation;
+    return 0;
+}
+
+yuv_orientation_t yuv_convert_orientation(void)
+{
+    return active_orientation;
+}
+
+const char *yuv_orientation_name(yuv_orientation_t orientation)
+{
+    if ((int)orientation < 0 || orientation >= YUV_ORIENT_COUNT)
+    {
+        return "unknown";
+    }
+    return orientation_names[orientation];
+}
+
+int yuv_orientation_transposes(yuv_orientation_t orientation)
+{
+    return (orientation & ORIENT_TRANSPOSE) != 0;
+}
+
+/******************************************************************************
+* function: yuv_convert_set_grayscale
+* brief: Switch luma-only conversion on or off, from the next frame on
+******************************************************************************/
+void yuv_convert_set_grayscale(int enable)
+{
+    grayscale = (enable != 0);
+}
+
+int yuv_convert_grayscale(void)
+{
+    return grayscale;
+}
+
+yuv_kernel_t yuv_convert_active_kernel(void)
+{
+    return active_kernel;
+}
+
+int yuv_kernel_available(yuv_kernel_t kernel)
+{
+    if ((int)kernel < 0 || kernel >= YUV_KERNEL_COUNT)
+    {
+        return 0;
+    }
+    return kernel_table[kernel].row[0] != NULL && kernel_supported[kernel];
+}
+
+const char *yuv_kernel_name(yuv_kernel_t kernel)
+{
+    if ((int)kernel < 0 || kernel >= YUV_KERNEL_COUNT)
+    {
+        return "unknown";
+    }
+    return kernel_table[kernel].name;
+}
+
+/******************************************************************************
+* function: yuv_frame_kernels_get
+* brief: Resolve the kernels of the active family and colorimetry
+*
+* Called once per frame, so a kernel, colorimetry, orientation or grayscale
+* change never lands mid-frame.
+******************************************************************************/
+void yuv_frame_kernels_get(yuv_frame_kernels *kernels)
+{
+    kernels->row = kernel_table[active_kernel].row[active_colorimetry];
+    kernels->pair = kernel_table[active_kernel].pair[active_colorimetry];
+    kernels->gray = grayscale ? kernel_table[active_kernel].gray[active_colorimetry] : NULL;
+    kernels->split_uv = kernel_table[active_kernel].split_uv;
+    kernels->split_yuyv = kernel_table[active_kernel].split_yuyv;
+    kernels->scale_rows = kernel_table[active_kernel].scale_rows;
+    kernels->orientation = active_orientation;
+}
+
+/******************************************************************************
+* function: yuv_output_setup
+* brief: Work out where each pixel of an oriented picture is written
+*
+* Output pixel (ox, oy) of pixel (x, y) is (x, y), with x taken from the
+* right when mirrored and y from the bottom when flipped; transposing
+* orientations use (y, x) instead, in a height-wide output. Mirroring
+* and flipping make the steps negative and move the origin to the far end,
+* so every orientation is a plain stride walk for the kernels.
+*
+* Parameters:
+*   out - output addressing to fill
+*   dst - big-endian RGB565 output buffer
+*   width, height - size of the picture before it is oriented
+*   orientation - output orientation
+******************************************************************************/
+void yuv_output_setup(yuv_output *out, uint8_t *dst, int width, int height,
+                      yuv_orientation_t orientation)
+{
+    int transposed = (orientation & ORIENT_TRANSPOSE) != 0;
+    int out_width = transposed ? height : width;
+    int out_height = transposed ? width : height;
+    ptrdiff_t pitch = (ptrdiff_t)out_width * 2;
+
+    // Steps along the output row (across) and down the output column
+    ptrdiff_t across = (orientation & ORIENT_MIRROR) ? -2 : 2;
+    ptrdiff_t down = (orientation & ORIENT_FLIP) ? -pitch : pitch;
+
+    out->origin = dst;
+    if (orientation & ORIENT_MIRROR)
+    {
+        out->origin += (out_width - 1) * 2;
+    }
+    if (orientation & ORIENT_FLIP)
+    {
+        out->origin += (out_height - 1) * pitch;
+    }
+
+    out->col_step = transposed ? down : across;
+    out->row_step = transposed ? across : down;
+}
+
+// Frame conversion job, shared by all bands
+typedef struct
+{
+    const uint8_t *frame;
+    yuv_format_t format;
+    int width;
+    int height;
+    yuv_output out;
+    yuv_frame_kernels k;
+    yuv_frame_histogram *luma;
+} frame_job;
+
+/******************************************************************************
+* function: gray_rows
+* brief: Expand rows [row_begin, row_end) of a luma plane to gray RGB565
+******************************************************************************/
+static void gray_rows(const frame_job *job, const uint8_t *y_plane, int row_begin, int row_end,
+                      yuv_band_histogram *hist)
+{
+    for (int row = row_begin; row < row_end; row++)
+    {
+        const uint8_t *y_row = y_plane + row * job->width;
+
+        job->k.gray(y_row, job->out.origin + row * job->out.row_step, job->width, job->out.col_step);
+        yuv_histogram_count(hist, y_row, job->width);
+    }
+}
+
+/******************************************************************************
+* function: i420_band
+* brief: Convert rows [row_begin, row_end) of an I420 frame (band callback)
+******************************************************************************/
+static void i420_band(void *ctx, int row_begin, int row_end)
+{
+    const frame_job *job = ctx;
+    int width = job->width;
+    const uint8_t *y_plane = job->frame;
+    const uint8_t *u_plane = y_plane + width * job->height;
+    const uint8_t *v_plane = u_plane + (width * job->height / 4);
+    int chroma_width = width / 2;
+    yuv_band_histogram hist;
+
+    yuv_histogram_clear(&hist);
+    if (job->k.gray)
+    {
+        gray_rows(job, y_plane, row_begin, row_end, &hist);
+    }
+    else
+    {
+        for (int row = row_begin; row < row_end; row += 2)
+        {
+            const uint8_t *y_row = y_plane + row * width;
+            uint8_t *dst_row = job->out.origin + row * job->out.row_step;
+            int uv_offset = (row >> 1) * chroma_width;
+
+            job->k.pair(y_row, y_row + width, u_plane + uv_offset, v_plane + uv_offset,
+                        dst_row, dst_row + job->out.row_step, width, job->out.col_step);
+            yuv_histogram_count(&hist, y_row, 2 * width);
+        }
+    }
+    yuv_histogram_merge(job->luma, &hist);
+}
+
+/******************************************************************************
+* function: nv_band
+* brief: Convert rows [row_begin, row_end) of an NV12/NV21 frame (band
+*        callback)
+*
+* Each chroma row is split into U and V scratch rows, which stay in L1, and
+* then goes through the same 2x2 block kernel as I420.
+******************************************************************************/
+static void nv_band(void *ctx, int row_begin, int row_end)
+{
+    const frame_job *job = ctx;
+    int width = job->width;
+    const uint8_t *y_plane = job->frame;
+    const uint8_t *uv_plane = y_plane + width * job->height;
+    uint8_t u_row[YUV_MAX_WIDTH / 2];
+    uint8_t v_row[YUV_MAX_WIDTH / 2];
+
+    // NV21 stores V first
+    uint8_t *first = (job->format == YUV_FORMAT_NV21) ? v_row : u_row;
+    uint8_t *second = (job->format == YUV_FORMAT_NV21) ? u_row : v_row;
+    yuv_band_histogram hist;
+
+    yuv_histogram_clear(&hist);
+    if (job->k.gray)
+    {
+        gray_rows(job, y_plane, row_begin, row_end, &hist);
+    }
+    else
+    {
+        for (int row = row_begin; row < row_end; row += 2)
+        {
+            const uint8_t *y_row = y_plane + row * width;
+            uint8_t *dst_row = job->out.origin + row * job->out.row_step;
+
+            job->k.split_uv(uv_plane + (row >> 1) * width, first, second, width / 2);
+            job->k.pair(y_row, y_row + width, u_row, v_row,
+                        dst_row, dst_row + job->out.row_step, width, job->out.col_step);
+            yuv_histogram_count(&hist, y_row, 2 * width);
+        }
+    }
+    yuv_histogram_merge(job->luma, &hist);
+}
+
+/******************************************************************************
+* function: yuyv_band
+* brief: Convert rows [row_begin, row_end) of a packed YUYV frame (band
+*        callback)
+*
+* YUYV carries chroma on every row (4:2:2), so each row is split into Y, U
+* and V scratch rows and converted with its own chroma by the row kernel.
+******************************************************************************/
+static void yuyv_band(void *ctx, int row_begin, int row_end)
+{
+    const frame_job *job = ctx;
+    int width = job->width;
+    uint8_t y_row[YUV_MAX_WIDTH];
+    uint8_t u_row[YUV_MAX_WIDTH / 2];
+    uint8_t v_row[YUV_MAX_WIDTH / 2];
+    yuv_band_histogram hist;
+
+    yuv_histogram_clear(&hist);
+    for (int row = row_begin; row < row_end; row++)
+    {
+        uint8_t *dst_row = job->out.origin + row * job->out.row_step;
+
+        // Packed luma has to be split out even in grayscale mode
+        job->k.split_yuyv(job->frame + row * width * 2, y_row, u_row, v_row, width);
+        if (job->k.gray)
+        {
+            job->k.gray(y_row, dst_row, width, job->out.col_step);
+        }
+        else
+        {
+            job->k.row(y_row, u_row, v_row, dst_row, width, job->out.col_step);
+        }
+        yuv_histogram_count(&hist, y_row, width);
+    }
+    yuv_histogram_merge(job->luma, &hist);
+}
+
+// Frame format descriptors, indexed by yuv_format_t
+static const struct
+{
+    const char *name;
+    int size_num;               // frame bytes per pixel, as a fraction
+    int size_den;
+    int chroma_rows;            // luma rows per chroma row
+    convert_band_fn band;
+} format_table[YUV_FORMAT_COUNT] =
+{
+    [YUV_FORMAT_I420] = { "i420", 3, 2, 2, i420_band },
+    [YUV_FORMAT_NV12] = { "nv12", 3, 2, 2, nv_band },
+    [YUV_FORMAT_NV21] = { "nv21", 3, 2, 2, nv_band },
+    [YUV_FORMAT_YUYV] = { "yuyv", 2, 1, 1, yuyv_band },
+};
+
+size_t yuv_frame_size(yuv_format_t format, int width, int height)
+{
+    if ((int)format < 0 || format >= YUV_FORMAT_COUNT || width <= 0 || height <= 0)
+    {
+        return 0;
+    }
+    return (size_t)width * height * format_table[format].size_num / format_table[format].size_den;
+}
+
+const char *yuv_format_name(yuv_format_t format)
+{
+    if ((int)format < 0 || format >= YUV_FORMAT_COUNT)
+    {
+        return "unknown";
+    }
+    return format_table[format].name;
+}
+
+/******************************************************************************
+* function: yuv_frame_to_rgb565
+* brief: Convert a frame in any supported layout to big-endian RGB565
+*
+* The frame is split into bands of whole row pairs; the call returns once
+* every band has been converted, and publishes the frame's luma statistics.
+*
+* Parameters:
+*   frame - input frame
+*   format - input layout
+*   width - frame width in pixels (even)
+*   height - frame height in pixels (even for 4:2:0 layouts)
+*   dst - output buffer, width * height * 2 bytes, in the active orientation
+*
+* returns 0 on success, -1 for an unknown format or unsupported size
+******************************************************************************/
+int yuv_frame_to_rgb565(const uint8_t *frame, yuv_format_t format,
+                        int width, int height, uint8_t *dst)
+{
+    if (yuv_frame_size(format, width, height) == 0 || (width & 1) ||
+        (height % format_table[format].chroma_rows) != 0 ||
+        (format != YUV_FORMAT_I420 && width > YUV_MAX_WIDTH))
+    {
+        fprintf(stderr, "Unsupported %s frame size %dx%d\n", yuv_format_name(format), width, height);
+        return -1;
+    }
+
+    yuv_frame_histogram luma = { { 0 } };
+    frame_job job =
+    {
+        .frame = frame,
+        .format = format,
+        .width = width,
+        .height = height,
+        .luma = &luma,
+    };
+    yuv_frame_kernels_get(&job.k);
+    yuv_output_setup(&job.out, dst, width, height, job.k.orientation);
+
+    convert_pool_run(format_table[format].band, &job, height);
+    yuv_histogram_publish(&luma);
+    return 0;
+}
+
+/******************************************************************************
+* function: yuv420_frame_to_rgb565
+* brief: Convert a planar I420 frame to big-endian RGB565
+*
+* Parameters:
+*   frame - Y plane followed by U and V planes
+*   width - frame width in pixels (even)
+*   height - frame height in pixels (even)
+*   dst - output buffer, width * height * 2 bytes
+******************************************************************************/
+void yuv420_frame_to_rgb565(const uint8_t *frame, int width, int height, uint8_t *dst)
+{
+    yuv_frame_to_rgb565(frame, YUV_FORMAT_I420, width, height, dst);
+}
@@ -0,0 +1,413 @@
+/******************************************************************************
+* YUV_CONVERT.H
+*
+* This header file defines the colorspace conversion engine used by the
+* camera driver to turn YUV420 frames into the big-endian RGB565 layout the
+* SSD1351 OLED expects. It provides:
+*   - The per-pixel reference conversion (yuv420_to_rgb)
+*   - Row and 2x2 block conversion kernels (scalar, lookup table, ARM NEON,
+*     x86 SSE4.1/AVX2)
+*   - Kernel selection so the fastest available path is used at runtime,
+*     based on a one-time CPU feature probe at program start
+*   - Colorimetry selection (BT.601/BT.709, limited/full range), made once
+*     per stream and served by kernel variants with the matrix compiled in
+*   - A benchmark that reports the cost of each kernel in cycles per pixel
+*   - Whole-frame conversion of I420, NV12, NV21 and YUYV input to RGB565
+*   - Area-averaging downscaling fused with the conversion, so a large
+*     capture can be shown at panel resolution in one pass
+*   - Output orientation (mirror, flip, 90/180/270 degree rotation), done by
+*     the kernels' output addressing rather than a separate pass
+*   - A grayscale mode that reads only luma (night mode)
+*   - Per-frame luma statistics (histogram, mean, min, max), counted by the
+*     conversion pass itself
+*
+* For a given colorimetry every kernel produces exactly the same output as
+* the scalar kernel, so the kernels can be swapped freely without changing
+* the picture.
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+*
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#ifndef YUV_CONVERT_H
+#define YUV_CONVERT_H
+
+#include <stdint.h>             // for uint8_t (8-bit unsigned integer)
+#include <stddef.h>             // defines size_t and ptrdiff_t
+
+// Available conversion kernels
+typedef enum
+{
+    YUV_KERNEL_SCALAR = 0,      // portable C (always available)
+    YUV_KERNEL_LUT,             // compile-time lookup tables (always available)
+    YUV_KERNEL_NEON,            // ARM NEON, 16 pixels per iteration
+    YUV_KERNEL_SSE41,           // x86 SSE4.1, 16 pixels per iteration
+    YUV_KERNEL_AVX2,            // x86 AVX2, 32 pixels per iteration
+    YUV_KERNEL_COUNT
+} yuv_kernel_t;
+
+// YUV matrix and range of the incoming stream
+typedef enum
+{
+    YUV_BT601_LIMITED = 0,      // SD video, libcamera "smpte170m" (default)
+    YUV_BT601_FULL,             // JPEG / libcamera "sycc"
+    YUV_BT709_LIMITED,          // HD video, libcamera "rec709"
+    YUV_BT709_FULL,             // full-range HD sources
+    YUV_COLORIMETRY_COUNT
+} yuv_colorimetry_t;
+
+// Input frame layouts
+typedef enum
+{
+    YUV_FORMAT_I420 = 0,        // Y plane, U plane, V plane (4:2:0)
+    YUV_FORMAT_NV12,            // Y plane, interleaved U/V plane (4:2:0)
+    YUV_FORMAT_NV21,            // Y plane, interleaved V/U plane (4:2:0)
+    YUV_FORMAT_YUYV,            // packed Y0 U Y1 V per pixel pair (4:2:2)
+    YUV_FORMAT_COUNT
+} yuv_format_t;
+
+// Orientation of the converted picture relative to the source frame
+typedef enum
+{
+    YUV_ORIENT_NORMAL = 0,      // as captured
+    YUV_ORIENT_MIRROR,          // left-right swapped (rear-view mirror)
+    YUV_ORIENT_FLIP,            // upside down
+    YUV_ORIENT_ROTATE_180,      // mirrored and flipped
+    YUV_ORIENT_TRANSPOSE,       // source rows become output columns
+    YUV_ORIENT_ROTATE_90,       // 90 degrees clockwise
+    YUV_ORIENT_ROTATE_270,      // 90 degrees counter-clockwise
+    YUV_ORIENT_TRANSVERSE,      // transposed across the other diagonal
+    YUV_ORIENT_COUNT
+} yuv_orientation_t;
+
+// Widest frame the semi-planar and packed formats accept; their rows are
+// split into per-thread scratch rows of this size on the stack
+#define YUV_MAX_WIDTH 2048
+
+// Downscaler limits: output size per axis and source-to-output ratio
+#define YUV_SCALE_MAX_OUT   256
+#define YUV_SCALE_MAX_RATIO 16
+
+// Rectangle in source pixels
+typedef struct
+{
+    int x;
+    int y;
+    int width;
+    int height;
+} yuv_rect;
+
+/******************************************************************************
+ * Row conversion kernel.
+ *
+ * Converts one row of 'width' pixels into big-endian RGB565. The chroma rows
+ * hold width/2 samples (4:2:0 horizontal subsampling).
+ *
+ * Pixel i is written at dst + i * step, which is how the output orientation
+ * is applied: 2 writes the row left to right, -2 right to left, and a
+ * multiple of the output row size writes it down (or up) a column.
+ *
+ * param y_row - luma samples for this row
+ * param u_row - U samples for this row
+ * param v_row - V samples for this row
+ * param dst - output of the first pixel, 2 bytes (high byte first)
+ * param width - number of pixels, must be even
+ * param step - byte offset between consecutive output pixels
+ *******************************************************************************/
+typedef void (*yuv_row_fn)(const uint8_t *y_row, const uint8_t *u_row,
+                           const uint8_t *v_row, uint8_t *dst, int width,
+                           ptrdiff_t step);
+
+/******************************************************************************
+ * Row-pair (2x2 block) conversion kernel.
+ *
+ * Converts the two luma rows that share one chroma row. The U/V terms are
+ * computed once per 2x2 block and applied to all four luma samples, and
+ * both output rows are written in the same pass.
+ *
+ * param y_row0, y_row1 - luma samples for the even and odd row
+ * param u_row, v_row - shared chroma samples (width/2)
+ * param dst0, dst1 - output of the first pixel of each row
+ * param width - number of pixels, must be even
+ * param step - byte offset between consecutive output pixels (see yuv_row_fn)
+ *******************************************************************************/
+typedef void (*yuv_pair_fn)(const uint8_t *y_row0, const uint8_t *y_row1,
+                            const uint8_t *u_row, const uint8_t *v_row,
+                            uint8_t *dst0, uint8_t *dst1, int width,
+                            ptrdiff_t step);
+
+/******************************************************************************
+ * Grayscale row kernel.
+ *
+ * Expands 'width' luma samples to gray big-endian RGB565 with the luma gain
+ * and offset of the colorimetry; chroma is never read. Same output as the
+ * color kernels for neutral chroma (U = V = 128).
+ *
+ * param y_row - luma samples
+ * param dst - output of the first pixel
+ * param width - number of pixels
+ * param step - byte offset between consecutive output pixels (see yuv_row_fn)
+ *******************************************************************************/
+typedef void (*yuv_gray_fn)(const uint8_t *y_row, uint8_t *dst, int width, ptrdiff_t step);
+
+/******************************************************************************
+ * Convert YUV420 color space to RGB. [colorspace conversion]
+ *
+ * BT.601 limited-range reference for a single pixel.
+ *
+ * param y - Y component
+ * param u - U component
+ * param v - V component
+ * param r Pointer to store R component
+ * param g Pointer to store G component
+ * param b Pointer to store B component
+ *******************************************************************************/
+void yuv420_to_rgb(uint8_t y, uint8_t u, uint8_t v, uint8_t *r, uint8_t *g, uint8_t *b);
+
+/******************************************************************************
+ * Select the conversion kernel.
+ *
+ * Overrides the kernel picked by the startup CPU probe, e.g. to compare
+ * against the scalar reference.
+ *
+ * param kernel - kernel to use for subsequent frame conversions
+ * returns 0 on success, -1 if the kernel was not compiled into this build
+ *******************************************************************************/
+int yuv_convert_select_kernel(yuv_kernel_t kernel);
+
+/******************************************************************************
+ * Get the kernel currently used for frame conversion.
+ *
+ * The fastest kernel compiled into the build and supported by the CPU is
+ * selected when the program starts.
+ *******************************************************************************/
+yuv_kernel_t yuv_convert_active_kernel(void);
+
+/******************************************************************************
+ * Check if a kernel is compiled into this build and supported by the CPU.
+ *
+ * returns 1 if available, 0 if not
+ *******************************************************************************/
+int yuv_kernel_available(yuv_kernel_t kernel);
+
+/******************************************************************************
+ * Get a printable name for a kernel.
+ *******************************************************************************/
+const char *yuv_kernel_name(yuv_kernel_t kernel);
+
+/******************************************************************************
+ * Set the colorimetry of the incoming stream.
+ *
+ * Call once when a stream starts; it selects the kernel variant with the
+ * stream's matrix and range compiled in, so the per-pixel code never
+ * branches on it. Kernel selection and colorimetry are independent.
+ *
+ * returns 0 on success, -1 for an unknown colorimetry
+ *******************************************************************************/
+int yuv_convert_set_colorimetry(yuv_colorimetry_t colorimetry);
+
+/******************************************************************************
+ * Get the colorimetry used for frame conversion (BT.601 limited by default).
+ *******************************************************************************/
+yuv_colorimetry_t yuv_convert_colorimetry(void);
+
+/******************************************************************************
+ * Get a printable name for a colorimetry.
+ *******************************************************************************/
+const char *yuv_colorimetry_name(yuv_colorimetry_t colorimetry);
+
+/******************************************************************************
+ * Set the orientation of the converted picture.
+ *
+ * Takes effect with the next frame; the kernels write each pixel straight
+ * to its rotated or mirrored position, so changing it costs nothing and
+ * needs no stream restart. Transposing orientations (TRANSPOSE, ROTATE_90,
+ * ROTATE_270, TRANSVERSE) swap the output width and height.
+ *
+ * returns 0 on success, -1 for an unknown orientation
+ *******************************************************************************/
+int yuv_convert_set_orientation(yuv_orientation_t orientation);
+
+/******************************************************************************
+ * Get the orientation used for frame conversion (YUV_ORIENT_NORMAL by
+ * default).
+ *******************************************************************************/
+yuv_orientation_t yuv_convert_orientation(void);
+
+/******************************************************************************
+ * Get a printable name for an orientation.
+ *******************************************************************************/
+const char *yuv_orientation_name(yuv_orientation_t orientation);
+
+/******************************************************************************
+ * Check if an orientation swaps the output width and height.
+ *
+ * returns 1 for the transposing orientations, 0 otherwise
+ *******************************************************************************/
+int yuv_orientation_transposes(yuv_orientation_t orientation);
+
+/******************************************************************************
+ * Switch grayscale (luma only) conversion on or off.
+ *
+ * In grayscale mode the frame conversions read only the luma samples and
+ * expand them with the active kernel's vector gray path, so planar and
+ * semi-planar frames skip the chroma plane entirely. Takes effect with the
+ * next frame.
+ *
+ * param enable - 1 for grayscale, 0 for color
+ *******************************************************************************/
+void yuv_convert_set_grayscale(int enable);
+
+/******************************************************************************
+ * Check if grayscale conversion is on (off by default).
+ *******************************************************************************/
+int yuv_convert_grayscale(void);
+
+/******************************************************************************
+ * Get the size in bytes of one frame in the given layout.
+ *
+ * returns the frame size, or 0 for an unknown format
+ *******************************************************************************/
+size_t yuv_frame_size(yuv_format_t format, int width, int height);
+
+/******************************************************************************
+ * Get a printable name for a frame format.
+ *******************************************************************************/
+const char *yuv_format_name(yuv_format_t format);
+
+/******************************************************************************
+ * Convert a frame in any supported layout to big-endian RGB565.
+ *
+ * 4:2:0 formats are processed in row pairs with the active kernel's 2x2
+ * block entry point, YUYV row by row with the row entry point. Interleaved
+ * chroma (and the packed YUYV samples) are split into small per-row scratch
+ * buffers right before the kernel runs, so no converted copy of the frame
+ * is ever made. Bands run on the conversion worker pool when it is running.
+ * The active orientation is applied as the pixels are written. Returns once
+ * the whole frame is converted.
+ *
+ * frame - frame in the given layout (yuv_frame_size bytes)
+ * format - frame layout
+ * width - frame width in pixels, must be even (at most YUV_MAX_WIDTH for
+ *         formats other than I420)
+ * height - frame height in pixels, must be even for 4:2:0 formats
+ * dst - output buffer of width * height * 2 bytes; its rows are 'height'
+ *       pixels wide when the orientation transposes
+ * returns 0 on success, -1 for an unknown format or unsupported size
+ *******************************************************************************/
+int yuv_frame_to_rgb565(const uint8_t *frame, yuv_format_t format,
+                        int width, int height, uint8_t *dst);
+
+/******************************************************************************
+ * Convert a planar I420 frame to big-endian RGB565.
+ *
+ * Same as yuv_frame_to_rgb565 with YUV_FORMAT_I420.
+ *
+ * frame - Y plane followed by the U and V planes (width * height * 3/2 bytes)
+ * width - frame width in pixels, must be even
+ * height - frame height in pixels, must be even
+ * dst - output buffer of width * height * 2 bytes
+ *******************************************************************************/
+void yuv420_frame_to_rgb565(const uint8_t *frame, int width, int height, uint8_t *dst);
+
+/******************************************************************************
+ * Scale a frame (or a crop of it) and convert it to big-endian RGB565.
+ *
+ * Each output pixel is the fixed-point area average of the source pixels
+ * it covers, e.g. 640x480 or 1280x720 down to 128x128. Scaling is fused
+ * with the conversion: every pair of output rows is resampled into small
+ * scratch rows and handed straight to the active 2x2 block kernel, so no
+ * scaled copy of the frame is made. The vertical pass, which touches every
+ * source byte, uses the SIMD version of the active kernel family. Bands
+ * run on the conversion worker pool. Crops smaller than the output are
+ * enlarged with the same area weights. The active orientation is applied
+ * as the pixels are written; with a transposing orientation the crop is
+ * scaled to dst_height x dst_width so the rotated picture fills dst.
+ *
+ * frame - source frame in the given layout
+ * format - source layout
+ * src_width, src_height - source frame size in pixels (even)
+ * crop - source region to show, NULL for the whole frame; its origin and
+ *        size are rounded down to even values
+ * dst - output buffer of dst_width * dst_height * 2 bytes
+ * dst_width, dst_height - output size (even, at most YUV_SCALE_MAX_OUT);
+ *        the crop may be at most YUV_SCALE_MAX_RATIO times larger per axis
+ *        and at most YUV_MAX_WIDTH wide
+ * returns 0 on success, -1 for an unsupported format, crop or size
+ *******************************************************************************/
+int yuv_frame_scale_to_rgb565(const uint8_t *frame, yuv_format_t format,
+                              int src_width, int src_height, const yuv_rect *crop,
+                              uint8_t *dst, int dst_width, int dst_height);
+
+/******************************************************************************
+ * Luma statistics of a converted frame.
+ *
+ * They describe the luma handed to the kernels, i.e. the picture as shown:
+ * with scaling that is the area-averaged crop at output resolution, which
+ * keeps the mean of the source but softens its extremes. 'frame' counts
+ * the frames converted so far, which tells a caller polling the statistics
+ * whether a new frame has arrived.
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t histogram[256];    // samples per luma value
+    uint32_t pixels;            // samples counted
+    uint8_t min;
+    uint8_t max;
+    float mean;
+    uint32_t frame;
+} yuv_luma_stats;
+
+/******************************************************************************
+ * Get the luma statistics of the last converted frame.
+ *
+ * Both yuv_frame_to_rgb565 and yuv_frame_scale_to_rgb565 gather them while
+ * converting; they are published once the whole frame is done.
+ *
+ * returns 0 on success, -1 if no frame has been converted yet
+ *******************************************************************************/
+int yuv_convert_luma_stats(yuv_luma_stats *stats);
+
+/******************************************************************************
+ * Kernel benchmark result.
+ *
+ * cycles_per_pixel comes from the CPU cycle counter when the kernel allows
+ * access to it (perf events), otherwise it is estimated from the elapsed
+ * time and the current CPU clock and cycles_measured is 0. It is 0 when
+ * neither source is available.
+ *******************************************************************************/
+typedef struct
+{
+    yuv_kernel_t kernel;
+    double ns_per_pixel;
+    double cycles_per_pixel;
+    int cycles_measured;
+} yuv_bench_result;
+
+/******************************************************************************
+ * Benchmark every available conversion kernel.
+ *
+ * Converts a synthetic width x height I420 frame 'frames' times with each
+ * kernel, prints a summary table and fills 'results'. The frames are
+ * converted on the calling thread alone, so the figures are per core: a
+ * running conversion pool is stopped for the run and restarted with the
+ * same number of workers. Do not call it while a stream is converting.
+ * The active kernel is restored afterwards.
+ *
+ * returns the number of results written
+ *******************************************************************************/
+int yuv_convert_benchmark(int width, int height, int frames,
+                          yuv_bench_result *results, int max_results);
+
+#endif /* YUV_CONVERT_H */
@@ -0,0 +1,213 @@
+/******************************************************************************
+* YUV_CONVERT_BENCH.C
+*
+* Benchmark for the conversion kernels. Each available kernel converts the
+* same synthetic frame a number of times and the cost is reported in
+* nanoseconds and CPU cycles per pixel, so the arithmetic, table-driven and
+* vector paths can be compared on the Pi's Cortex-A cores.
+*
+* Cycles are read from the hardware cycle counter through perf events. When
+* the kernel does not allow that (perf_event_paranoid, or no PMU driver),
+* cycles are estimated from the elapsed time and the current CPU clock
+* reported by cpufreq.
+*
+* The counter only counts the calling thread, so the conversion pool is
+* stopped for the run and every frame is converted on the caller alone;
+* otherwise the bands of the worker threads would be missing from the
+* cycles while the elapsed time covers all cores. The pool is restarted
+* with the same number of workers afterwards.
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "yuv_convert.h"
+#include "convert_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>   // hardware cycle counter
+
+#define CPUFREQ_PATH "/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq"
+
+/******************************************************************************
+* function: open_cycle_counter
+* brief: Open a per-thread CPU cycle counter
+*
+* returns the perf event file descriptor, or -1 if cycles are not available
+******************************************************************************/
+static int open_cycle_counter(void)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/******************************************************************************
+* function: read_cpu_khz
+* brief: Current CPU clock in kHz from cpufreq, 0 if unknown
+******************************************************************************/
+static long read_cpu_khz(void)
+{
+    long khz = 0;
+    FILE *file = fopen(CPUFREQ_PATH, "r");
+    if (file)
+    {
+        if (fscanf(file, "%ld", &khz) != 1)
+        {
+            khz = 0;
+        }
+        fclose(file);
+    }
+    return khz;
+}
+
+/******************************************************************************
+* function: yuv_convert_benchmark
+* brief: Benchmark every available conversion kernel
+*
+* Parameters:
+*   width, height - synthetic frame size (even)
+*   frames - number of conversions per kernel
+*   results - output array
+*   max_results - capacity of 'results'
+*
+* returns the number of results written, -1 on allocation failure
+******************************************************************************/
+int yuv_convert_benchmark(int width, int height, int frames,
+                          yuv_bench_result *results, int max_results)
+{
+    size_t frame_size = (size_t)width * height * 3 / 2;
+    size_t pixels = (size_t)width * height;
+    uint8_t *frame = malloc(frame_size);
+    uint8_t *rgb = malloc(pixels * 2);
+
+    if (!frame || !rgb)
+    {
+        perror("Failed to allocate benchmark buffers");
+        free(frame);
+        free(rgb);
+        return -1;
+    }
+
+    // Synthetic gradient frame so every table entry and clamp path gets used
+    for (size_t i = 0; i < frame_size; i++)
+    {
+        frame[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+
+    yuv_kernel_t saved = yuv_convert_active_kernel();
+    int workers = convert_pool_workers();
+    int cycle_fd = open_cycle_counter();
+    int count = 0;
+
+    // One thread, so the per-thread counter sees every converted row
+    if (workers > 1)
+    {
+        convert_pool_stop();
+    }
+
+    printf("Conversion benchmark: %dx%d, %d frames per kernel\n", width, height, frames);
+    printf("  measured on one thread%s, cycles %s\n", (workers > 1) ? " (conversion pool paused)" : "",
+           (cycle_fd >= 0) ? "from the CPU cycle counter" : "estimated from the CPU clock");
+    printf("  %-8s %10s %12s\n", "kernel", "ns/pixel", "cycles/pixel");
+
+    for (int k = 0; k < YUV_KERNEL_COUNT && count < max_results; k++)
+    {
+        if (!yuv_kernel_available((yuv_kernel_t)k))
+        {
+            continue;
+        }
+        yuv_convert_select_kernel((yuv_kernel_t)k);
+
+        // Warm-up pass so caches and tables are hot
+        yuv420_frame_to_rgb565(frame, width, height, rgb);
+
+        struct timespec start, end;
+        long long cycles = 0;
+
+        if (cycle_fd >= 0)
+        {
+            ioctl(cycle_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(cycle_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        for (int i = 0; i < frames; i++)
+        {
+            yuv420_frame_to_rgb565(frame, width, height, rgb);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (cycle_fd >= 0)
+        {
+            ioctl(cycle_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(cycle_fd, &cycles, sizeof(cycles)) != sizeof(cycles))
+            {
+                cycles = 0;
+            }
+        }
+
+        double elapsed_ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+        double total_pixels = (double)pixels * frames;
+
+        yuv_bench_result *res = &results[count++];
+        res->kernel = (yuv_kernel_t)k;
+        res->ns_per_pixel = elapsed_ns / total_pixels;
+        res->cycles_measured = cycles > 0;
+        if (res->cycles_measured)
+        {
+            res->cycles_per_pixel = cycles / total_pixels;
+        }
+        else
+        {
+            // Estimate: ns * GHz = cycles
+            res->cycles_per_pixel = res->ns_per_pixel * read_cpu_khz() / 1e6;
+        }
+
+        if (res->cycles_per_pixel > 0)
+        {
+            printf("  %-8s %10.2f %12.2f%s\n", yuv_kernel_name(res->kernel), res->ns_per_pixel,
+                   res->cycles_per_pixel, res->cycles_measured ? "" : " (estimated)");
+        }
+        else
+        {
+            printf("  %-8s %10.2f %12s\n", yuv_kernel_name(res->kernel), res->ns_per_pixel, "n/a");
+        }
+    }
+
+    if (cycle_fd >= 0)
+    {
+        close(cycle_fd);
+    }
+    if (workers > 1)
+    {
+        convert_pool_start(workers);
+    }
+    yuv_convert_select_kernel(saved);
+    free(frame);
+    free(rgb);
+
+    return count;
+}
@@ -0,0 +1,201 @@
+/******************************************************************************
+* YUV_CONVERT_LUT.C
+*
+* Table-driven row kernel for the YUV420 to RGB565 conversion. Instead of the
+* multiply-adds and clamps of yuv420_to_rgb, each pixel takes:
+*   - one lookup for the luma contribution
+*   - three clamp-table lookups that return the channel already masked and
+*     shifted into its RGB565 bit position
+* and the chroma contributions are looked up once per U/V pair (row kernel)
+* or once per 2x2 block (pair kernel). The grayscale kernel takes a single
+* lookup per pixel that returns the finished RGB565 gray.
+*
+* All tables are generated by the preprocessor as static const data, one set
+* of contribution tables per colorimetry and one shared set of clamp tables,
+* so they cost nothing at startup and live in read-only memory. The output
+* is bit-identical to the scalar kernels.
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "yuv_kernels.h"
+
+// Table generators: expand f(i, ...) for consecutive indices at compile time
+#define LUT_GEN4(f, i, ...)    f(i, __VA_ARGS__), f((i) + 1, __VA_ARGS__), \
+                               f((i) + 2, __VA_ARGS__), f((i) + 3, __VA_ARGS__)
+#define LUT_GEN16(f, i, ...)   LUT_GEN4(f, i, __VA_ARGS__), LUT_GEN4(f, (i) + 4, __VA_ARGS__), \
+                               LUT_GEN4(f, (i) + 8, __VA_ARGS__), LUT_GEN4(f, (i) + 12, __VA_ARGS__)
+#define LUT_GEN64(f, i, ...)   LUT_GEN16(f, i, __VA_ARGS__), LUT_GEN16(f, (i) + 16, __VA_ARGS__), \
+                               LUT_GEN16(f, (i) + 32, __VA_ARGS__), LUT_GEN16(f, (i) + 48, __VA_ARGS__)
+#define LUT_GEN256(f, i, ...)  LUT_GEN64(f, i, __VA_ARGS__), LUT_GEN64(f, (i) + 64, __VA_ARGS__), \
+                               LUT_GEN64(f, (i) + 128, __VA_ARGS__), LUT_GEN64(f, (i) + 192, __VA_ARGS__)
+
+// Contribution of one sample: gain * (i - offset) + bias (rounding is
+// folded into the chroma tables)
+#define LUT_TERM(i, gain, offset, bias) ((gain) * ((i) - (offset)) + (bias))
+
+// Saturating clamp tables, indexed by (sum >> 8) + LUT_CLAMP_OFFSET, shared
+// by all colorimetries. The shifted sums span [-289, 547] for 8-bit input
+// (BT.709 limited range is the widest), inside [-320, 575].
+#define LUT_CLAMP_OFFSET 320
+#define LUT_CLAMP_SIZE   896
+#define LUT_CLAMP8(i)    ((i) < 0 ? 0 : ((i) > 255 ? 255 : (i)))
+#define LUT_R565(i, ...) (uint16_t)((LUT_CLAMP8((i) - LUT_CLAMP_OFFSET) & 0xF8) << 8)
+#define LUT_G565(i, ...) (uint16_t)((LUT_CLAMP8((i) - LUT_CLAMP_OFFSET) & 0xFC) << 3)
+#define LUT_B565(i, ...) (uint16_t)(LUT_CLAMP8((i) - LUT_CLAMP_OFFSET) >> 3)
+#define LUT_GEN896(f)    LUT_GEN256(f, 0, 0), LUT_GEN256(f, 256, 0), LUT_GEN256(f, 512, 0), \
+                         LUT_GEN64(f, 768, 0), LUT_GEN64(f, 832, 0)
+
+static const uint16_t lut_clamp_r[LUT_CLAMP_SIZE] = { LUT_GEN896(LUT_R565) };
+static const uint16_t lut_clamp_g[LUT_CLAMP_SIZE] = { LUT_GEN896(LUT_G565) };
+static const uint16_t lut_clamp_b[LUT_CLAMP_SIZE] = { LUT_GEN896(LUT_B565) };
+
+// Finished RGB565 gray for one luma sample (neutral chroma)
+#define LUT_GRAY8(i, gain, offset)   LUT_CLAMP8(((gain) * ((i) - (offset)) + 128) >> 8)
+#define LUT_GRAY565(i, gain, offset) (uint16_t)(((LUT_GRAY8(i, gain, offset) & 0xF8) << 8) | \
+                                                ((LUT_GRAY8(i, gain, offset) & 0xFC) << 3) | \
+                                                (LUT_GRAY8(i, gain, offset) >> 3))
+
+// Contribution tables of one colorimetry
+typedef struct
+{
+    int32_t y[256];
+    int32_t rv[256];
+    int32_t gu[256];
+    int32_t gv[256];
+    int32_t bu[256];
+    uint16_t gray[256];
+} lut_tables;
+
+/******************************************************************************
+* function: lut_pixel
+* brief: Convert one pixel from its luma term and the shared chroma terms
+******************************************************************************/
+static inline void lut_pixel(uint8_t *dst, int32_t y_term, int32_t r_term, int32_t g_term, int32_t b_term)
+{
+    uint16_t color = lut_clamp_r[((y_term + r_term) >> 8) + LUT_CLAMP_OFFSET]
+                   | lut_clamp_g[((y_term + g_term) >> 8) + LUT_CLAMP_OFFSET]
+                   | lut_clamp_b[((y_term + b_term) >> 8) + LUT_CLAMP_OFFSET];
+
+    dst[0] = color >> 8;
+    dst[1] = color & 0xFF;
+}
+
+/******************************************************************************
+* function: lut_row
+* brief: Table-driven row kernel body
+*
+* Parameters:
+*   y_row - luma samples
+*   u_row - U samples (width/2)
+*   v_row - V samples (width/2)
+*   dst - big-endian RGB565 output of the first pixel
+*   width - number of pixels (even)
+*   step - byte offset between consecutive output pixels
+*   t - contribution tables of the stream's colorimetry
+******************************************************************************/
+YUV_INLINE void lut_row(const uint8_t *y_row, const uint8_t *u_row,
+                        const uint8_t *v_row, uint8_t *dst, int width,
+                        ptrdiff_t step, const lut_tables *t)
+{
+    for (int col = 0; col < width; col += 2)
+    {
+        uint8_t u_val = u_row[col >> 1];
+        uint8_t v_val = v_row[col >> 1];
+
+        int32_t r_term = t->rv[v_val];
+        int32_t g_term = t->gu[u_val] + t->gv[v_val];
+        int32_t b_term = t->bu[u_val];
+
+        lut_pixel(dst,        t->y[y_row[col]],     r_term, g_term, b_term);
+        lut_pixel(dst + step, t->y[y_row[col + 1]], r_term, g_term, b_term);
+        dst += 2 * step;
+    }
+}
+
+/******************************************************************************
+* function: lut_pair
+* brief: Table-driven 2x2 block kernel body
+******************************************************************************/
+YUV_INLINE void lut_pair(const uint8_t *y_row0, const uint8_t *y_row1,
+                         const uint8_t *u_row, const uint8_t *v_row,
+                         uint8_t *dst0, uint8_t *dst1, int width,
+                         ptrdiff_t step, const lut_tables *t)
+{
+    for (int col = 0; col < width; col += 2)
+    {
+        uint8_t u_val = u_row[col >> 1];
+        uint8_t v_val = v_row[col >> 1];
+
+        int32_t r_term = t->rv[v_val];
+        int32_t g_term = t->gu[u_val] + t->gv[v_val];
+        int32_t b_term = t->bu[u_val];
+
+        lut_pixel(dst0,        t->y[y_row0[col]],     r_term, g_term, b_term);
+        lut_pixel(dst0 + step, t->y[y_row0[col + 1]], r_term, g_term, b_term);
+        lut_pixel(dst1,        t->y[y_row1[col]],     r_term, g_term, b_term);
+        lut_pixel(dst1 + step, t->y[y_row1[col + 1]], r_term, g_term, b_term);
+        dst0 += 2 * step;
+        dst1 += 2 * step;
+    }
+}
+
+/******************************************************************************
+* function: lut_gray
+* brief: Table-driven grayscale kernel body, one lookup per pixel
+******************************************************************************/
+YUV_INLINE void lut_gray(const uint8_t *y_row, uint8_t *dst, int width,
+                         ptrdiff_t step, const lut_tables *t)
+{
+    for (int col = 0; col < width; col++)
+    {
+        uint16_t color = t->gray[y_row[col]];
+
+        dst[0] = color >> 8;
+        dst[1] = color & 0xFF;
+        dst += step;
+    }
+}
+
+// Tables plus yuv_row/pair/gray_lut_<colorimetry>
+#define LUT_KERNELS(family, name, y_offset, y_gain, r_v, g_u, g_v, b_u) \
+    static const lut_tables lut_##name = \
+    { \
+        { LUT_GEN256(LUT_TERM, 0, y_gain, y_offset, 0) }, \
+        { LUT_GEN256(LUT_TERM, 0, r_v, 128, 128) }, \
+        { LUT_GEN256(LUT_TERM, 0, g_u, 128, 0) }, \
+        { LUT_GEN256(LUT_TERM, 0, g_v, 128, 128) }, \
+        { LUT_GEN256(LUT_TERM, 0, b_u, 128, 128) }, \
+        { LUT_GEN256(LUT_GRAY565, 0, y_gain, y_offset) }, \
+    }; \
+    void yuv_row_##family##_##name(const uint8_t *y_row, const uint8_t *u_row, \
+                                   const uint8_t *v_row, uint8_t *dst, int width, \
+                                   ptrdiff_t step) \
+    { \
+        lut_row(y_row, u_row, v_row, dst, width, step, &lut_##name); \
+    } \
+    void yuv_pair_##family##_##name(const uint8_t *y_row0, const uint8_t *y_row1, \
+                                    const uint8_t *u_row, const uint8_t *v_row, \
+                                    uint8_t *dst0, uint8_t *dst1, int width, \
+                                    ptrdiff_t step) \
+    { \
+        lut_pair(y_row0, y_row1, u_row, v_row, dst0, dst1, width, step, &lut_##name); \
+    } \
+    void yuv_gray_##family##_##name(const uint8_t *y_row, uint8_t *dst, int width, \
+                                    ptrdiff_t step) \
+    { \
+        lut_gray(y_row, dst, width, step, &lut_##name); \
+    }
+
+YUV_COLORIMETRIES(LUT_KERNELS, lut)
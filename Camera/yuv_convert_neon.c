@@ -0,0 +1,391 @@
+/******************************************************************************
+* YUV_CONVERT_NEON.C
+*
+* ARM NEON row kernel for the YUV420 to RGB565 conversion. Each iteration
+* converts 16 pixels: 16 luma samples and 8 U/V pairs are loaded, the color
+* terms are evaluated in 16-bit lanes (see yuv_kernels.h for the exact split
+* of the fixed-point formula), and the result is packed to big-endian RGB565
+* with shift-insert and written with a single interleaving store.
+*
+* The pair kernel computes the chroma terms once and applies them to both
+* luma rows of a 2x2 block row. Mirrored output reverses the 16 pixels in
+* registers before the store, and rotated output stores each pixel with a
+* lane store into its own output row. The grayscale kernel runs only the
+* luma half of the arithmetic and shares the packing and stores. NV12/NV21
+* chroma and packed YUYV rows are split with structure loads (vld2/vld4)
+* before they reach the kernels. The downscaler's vertical pass
+* (yuv_scale_rows_neon) is here as well.
+*
+* The kernel bodies take the colorimetry coefficients as constants and are
+* instantiated once per colorimetry at the end of the file. The output is
+* bit-identical to the scalar kernels. Compiled only when the compiler
+* targets NEON (aarch64, or armhf with -mfpu=neon).
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "yuv_kernels.h"
+
+#ifdef YUV_HAVE_NEON
+#include <arm_neon.h>
+
+// Chroma terms for 16 pixels, already duplicated onto both pixels of a pair
+typedef struct
+{
+    int16x8x2_t r_base, g_base, b_base;
+    int16x8x2_t r_frac, g_frac, b_frac;
+} neon_chroma;
+
+/******************************************************************************
+* function: neon_chroma_terms
+* brief: Compute the chroma terms for 8 U/V pairs (16 pixels)
+******************************************************************************/
+YUV_INLINE void neon_chroma_terms(const uint8_t *u_ptr, const uint8_t *v_ptr, neon_chroma *t,
+                                  yuv_coeffs k)
+{
+    const uint8x8_t k128 = vdup_n_u8(128);
+    const int16x8_t bias = vdupq_n_s16(128);
+
+    // d = u - 128, e = v - 128 (wrapping subtract, read as signed)
+    int16x8_t d = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(u_ptr), k128));
+    int16x8_t e = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(v_ptr), k128));
+
+    int16x8_t r_frac = vmlaq_n_s16(bias, e, YUV_FRAC(k.r_v));
+    int16x8_t g_frac = vmlaq_n_s16(vmlaq_n_s16(bias, d, YUV_FRAC(k.g_u)), e, YUV_FRAC(k.g_v));
+    int16x8_t b_frac = vmlaq_n_s16(bias, d, YUV_FRAC(k.b_u));
+    int16x8_t r_base = vmulq_n_s16(e, YUV_WHOLE(k.r_v));
+    int16x8_t g_base = vmlaq_n_s16(vmulq_n_s16(d, YUV_WHOLE(k.g_u)), e, YUV_WHOLE(k.g_v));
+    int16x8_t b_base = vmulq_n_s16(d, YUV_WHOLE(k.b_u));
+
+    // Duplicate each chroma term onto its two horizontal pixels
+    t->r_base = vzipq_s16(r_base, r_base);
+    t->g_base = vzipq_s16(g_base, g_base);
+    t->b_base = vzipq_s16(b_base, b_base);
+    t->r_frac = vzipq_s16(r_frac, r_frac);
+    t->g_frac = vzipq_s16(g_frac, g_frac);
+    t->b_frac = vzipq_s16(b_frac, b_frac);
+}
+
+/******************************************************************************
+* function: neon_channel
+* brief: Finish one color channel for 8 pixels
+*
+* Adds the whole-unit part and the rounded fractional part, then saturates
+* to [0, 255].
+******************************************************************************/
+static inline uint8x8_t neon_channel(int16x8_t lc, int16x8_t lf, int16x8_t base, int16x8_t frac)
+{
+    int16x8_t whole = vaddq_s16(lc, base);
+    int16x8_t part = vshrq_n_s16(vaddq_s16(lf, frac), 8);
+    return vqmovun_s16(vaddq_s16(whole, part));
+}
+
+// Store pixel 'i' of 8 RGB565 pixels (high and low bytes in two vectors)
+#define NEON_STORE_PIXEL(px, i, dst, step) vst2_lane_u8((dst) + (i) * (step), px, i)
+
+/******************************************************************************
+* function: neon_store_pixels
+* brief: Store 16 RGB565 pixels 'step' bytes apart
+*
+* Step 2 is the plain interleaving row store. For step -2 (mirrored row)
+* the pixels end at dst, so both byte vectors are reversed and stored below
+* it. Any other step puts each pixel in its own output row (rotated output).
+******************************************************************************/
+static inline void neon_store_pixels(uint8x16x2_t px, uint8_t *dst, ptrdiff_t step)
+{
+    if (step == YUV_STEP_FORWARD)
+    {
+        vst2q_u8(dst, px);
+    }
+    else if (step == YUV_STEP_REVERSE)
+    {
+        uint8x16_t hi = vrev64q_u8(px.val[0]);
+        uint8x16_t lo = vrev64q_u8(px.val[1]);
+        uint8x16x2_t rev;
+
+        rev.val[0] = vcombine_u8(vget_high_u8(hi), vget_low_u8(hi));
+        rev.val[1] = vcombine_u8(vget_high_u8(lo), vget_low_u8(lo));
+        vst2q_u8(dst - 30, rev);
+    }
+    else
+    {
+        uint8x8x2_t lo = { { vget_low_u8(px.val[0]), vget_low_u8(px.val[1]) } };
+        uint8x8x2_t hi = { { vget_high_u8(px.val[0]), vget_high_u8(px.val[1]) } };
+        uint8_t *dst_hi = dst + 8 * step;
+
+        NEON_STORE_PIXEL(lo, 0, dst, step);
+        NEON_STORE_PIXEL(lo, 1, dst, step);
+        NEON_STORE_PIXEL(lo, 2, dst, step);
+        NEON_STORE_PIXEL(lo, 3, dst, step);
+        NEON_STORE_PIXEL(lo, 4, dst, step);
+        NEON_STORE_PIXEL(lo, 5, dst, step);
+        NEON_STORE_PIXEL(lo, 6, dst, step);
+        NEON_STORE_PIXEL(lo, 7, dst, step);
+        NEON_STORE_PIXEL(hi, 0, dst_hi, step);
+        NEON_STORE_PIXEL(hi, 1, dst_hi, step);
+        NEON_STORE_PIXEL(hi, 2, dst_hi, step);
+        NEON_STORE_PIXEL(hi, 3, dst_hi, step);
+        NEON_STORE_PIXEL(hi, 4, dst_hi, step);
+        NEON_STORE_PIXEL(hi, 5, dst_hi, step);
+        NEON_STORE_PIXEL(hi, 6, dst_hi, step);
+        NEON_STORE_PIXEL(hi, 7, dst_hi, step);
+    }
+}
+
+/******************************************************************************
+* function: neon_pack_store
+* brief: Pack 16 pixels of 8-bit RGB to big-endian RGB565 and store them
+******************************************************************************/
+static inline void neon_pack_store(uint8x16_t r, uint8x16_t g, uint8x16_t b, uint8_t *dst,
+                                   ptrdiff_t step)
+{
+    // Pack RGB565: high = RRRRRGGG, low = GGGBBBBB
+    uint8x16x2_t px;
+    px.val[0] = vsriq_n_u8(r, g, 5);
+    px.val[1] = vsriq_n_u8(vshlq_n_u8(g, 3), b, 3);
+    neon_store_pixels(px, dst, step);
+}
+
+/******************************************************************************
+* function: neon_luma_store
+* brief: Apply the chroma terms to 16 luma samples and store RGB565
+******************************************************************************/
+YUV_INLINE void neon_luma_store(const uint8_t *y_ptr, const neon_chroma *t, uint8_t *dst,
+                                ptrdiff_t step, yuv_coeffs k)
+{
+    const uint8x8_t y_offset = vdup_n_u8(k.y_offset);
+    uint8x16_t y = vld1q_u8(y_ptr);
+
+    // c = y - y_offset (wrapping subtract, read as signed), split into whole
+    // and fractional gain parts
+    int16x8_t c_lo = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(y), y_offset));
+    int16x8_t c_hi = vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(y), y_offset));
+    int16x8_t lc_lo = vmulq_n_s16(c_lo, YUV_WHOLE(k.y_gain));
+    int16x8_t lc_hi = vmulq_n_s16(c_hi, YUV_WHOLE(k.y_gain));
+    int16x8_t lf_lo = vmulq_n_s16(c_lo, YUV_FRAC(k.y_gain));
+    int16x8_t lf_hi = vmulq_n_s16(c_hi, YUV_FRAC(k.y_gain));
+
+    uint8x16_t r = vcombine_u8(neon_channel(lc_lo, lf_lo, t->r_base.val[0], t->r_frac.val[0]),
+                               neon_channel(lc_hi, lf_hi, t->r_base.val[1], t->r_frac.val[1]));
+    uint8x16_t g = vcombine_u8(neon_channel(lc_lo, lf_lo, t->g_base.val[0], t->g_frac.val[0]),
+                               neon_channel(lc_hi, lf_hi, t->g_base.val[1], t->g_frac.val[1]));
+    uint8x16_t b = vcombine_u8(neon_channel(lc_lo, lf_lo, t->b_base.val[0], t->b_frac.val[0]),
+                               neon_channel(lc_hi, lf_hi, t->b_base.val[1], t->b_frac.val[1]));
+
+    neon_pack_store(r, g, b, dst, step);
+}
+
+/******************************************************************************
+* function: neon_gray
+* brief: NEON grayscale kernel body, 16 pixels per iteration
+*
+* The luma term of neon_luma_store with zero chroma terms and the rounding
+* bias as the remainder.
+******************************************************************************/
+YUV_INLINE void neon_gray(const uint8_t *y_row, uint8_t *dst, int width,
+                          ptrdiff_t step, yuv_coeffs k, yuv_gray_fn tail)
+{
+    const uint8x8_t y_offset = vdup_n_u8(k.y_offset);
+    const int16x8_t zero = vdupq_n_s16(0);
+    const int16x8_t bias = vdupq_n_s16(128);
+    int col = 0;
+
+    for (; col + 16 <= width; col += 16)
+    {
+        uint8x16_t y = vld1q_u8(y_row + col);
+        int16x8_t c_lo = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(y), y_offset));
+        int16x8_t c_hi = vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(y), y_offset));
+        uint8x16_t v = vcombine_u8(neon_channel(vmulq_n_s16(c_lo, YUV_WHOLE(k.y_gain)),
+                                                vmulq_n_s16(c_lo, YUV_FRAC(k.y_gain)), zero, bias),
+                                   neon_channel(vmulq_n_s16(c_hi, YUV_WHOLE(k.y_gain)),
+                                                vmulq_n_s16(c_hi, YUV_FRAC(k.y_gain)), zero, bias));
+
+        neon_pack_store(v, v, v, dst + col * step, step);
+    }
+
+    if (col < width)
+    {
+        tail(y_row + col, dst + col * step, width - col, step);
+    }
+}
+
+/******************************************************************************
+* function: neon_row
+* brief: NEON row kernel body, 16 pixels per iteration
+*
+* Parameters:
+*   y_row - luma samples
+*   u_row - U samples (width/2)
+*   v_row - V samples (width/2)
+*   dst - big-endian RGB565 output of the first pixel
+*   width - number of pixels (even); leftovers below 16 go to 'tail'
+*   step - byte offset between consecutive output pixels
+*   k - colorimetry coefficients (compile-time constants)
+*   tail - scalar kernel of the same colorimetry
+******************************************************************************/
+YUV_INLINE void neon_row(const uint8_t *y_row, const uint8_t *u_row,
+                         const uint8_t *v_row, uint8_t *dst, int width,
+                         ptrdiff_t step, yuv_coeffs k, yuv_row_fn tail)
+{
+    neon_chroma t;
+    int col = 0;
+
+    for (; col + 16 <= width; col += 16)
+    {
+        neon_chroma_terms(u_row + (col >> 1), v_row + (col >> 1), &t, k);
+        neon_luma_store(y_row + col, &t, dst + col * step, step, k);
+    }
+
+    if (col < width)
+    {
+        tail(y_row + col, u_row + (col >> 1), v_row + (col >> 1),
+             dst + col * step, width - col, step);
+    }
+}
+
+/******************************************************************************
+* function: neon_pair
+* brief: NEON 2x2 block kernel body, 16x2 pixels per iteration
+******************************************************************************/
+YUV_INLINE void neon_pair(const uint8_t *y_row0, const uint8_t *y_row1,
+                          const uint8_t *u_row, const uint8_t *v_row,
+                          uint8_t *dst0, uint8_t *dst1, int width,
+                          ptrdiff_t step, yuv_coeffs k, yuv_pair_fn tail)
+{
+    neon_chroma t;
+    int col = 0;
+
+    for (; col + 16 <= width; col += 16)
+    {
+        neon_chroma_terms(u_row + (col >> 1), v_row + (col >> 1), &t, k);
+        neon_luma_store(y_row0 + col, &t, dst0 + col * step, step, k);
+        neon_luma_store(y_row1 + col, &t, dst1 + col * step, step, k);
+    }
+
+    if (col < width)
+    {
+        tail(y_row0 + col, y_row1 + col, u_row + (col >> 1), v_row + (col >> 1),
+             dst0 + col * step, dst1 + col * step, width - col, step);
+    }
+}
+
+/******************************************************************************
+* function: yuv_split_uv_neon
+* brief: Split interleaved chroma into two rows, 16 pairs per iteration
+******************************************************************************/
+void yuv_split_uv_neon(const uint8_t *uv, uint8_t *first, uint8_t *second, int pairs)
+{
+    int i = 0;
+
+    for (; i + 16 <= pairs; i += 16)
+    {
+        uint8x16x2_t px = vld2q_u8(uv + 2 * i);
+        vst1q_u8(first + i, px.val[0]);
+        vst1q_u8(second + i, px.val[1]);
+    }
+
+    if (i < pairs)
+    {
+        yuv_split_uv_scalar(uv + 2 * i, first + i, second + i, pairs - i);
+    }
+}
+
+/******************************************************************************
+* function: yuv_split_yuyv_neon
+* brief: Split packed YUYV into Y, U and V rows, 32 pixels per iteration
+******************************************************************************/
+void yuv_split_yuyv_neon(const uint8_t *yuyv, uint8_t *y, uint8_t *u, uint8_t *v, int width)
+{
+    int col = 0;
+
+    for (; col + 32 <= width; col += 32)
+    {
+        // val[0] = Y0, val[1] = U, val[2] = Y1, val[3] = V
+        uint8x16x4_t px = vld4q_u8(yuyv + 2 * col);
+        uint8x16x2_t luma = { { px.val[0], px.val[2] } };
+
+        vst2q_u8(y + col, luma);
+        vst1q_u8(u + (col >> 1), px.val[1]);
+        vst1q_u8(v + (col >> 1), px.val[3]);
+    }
+
+    if (col < width)
+    {
+        yuv_split_yuyv_scalar(yuyv + 2 * col, y + col, u + (col >> 1), v + (col >> 1), width - col);
+    }
+}
+
+/******************************************************************************
+* function: yuv_scale_rows_neon
+* brief: Vertical downscaler pass, 16 bytes per iteration
+*
+* Weights add up to 256, so the 16-bit accumulator never wraps.
+******************************************************************************/
+void yuv_scale_rows_neon(const uint8_t *const *rows, const uint16_t *weights,
+                         int taps, uint8_t *dst, int n)
+{
+    int x = 0;
+
+    for (; x + 16 <= n; x += 16)
+    {
+        uint16x8_t lo = vdupq_n_u16(128);
+        uint16x8_t hi = vdupq_n_u16(128);
+
+        for (int t = 0; t < taps; t++)
+        {
+            uint8x16_t px = vld1q_u8(rows[t] + x);
+            lo = vmlaq_n_u16(lo, vmovl_u8(vget_low_u8(px)), weights[t]);
+            hi = vmlaq_n_u16(hi, vmovl_u8(vget_high_u8(px)), weights[t]);
+        }
+        vst1q_u8(dst + x, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+    }
+
+    if (x < n)
+    {
+        const uint8_t *tail[YUV_SCALE_MAX_TAPS];
+
+        for (int t = 0; t < taps; t++)
+        {
+            tail[t] = rows[t] + x;
+        }
+        yuv_scale_rows_scalar(tail, weights, taps, dst + x, n - x);
+    }
+}
+
+// yuv_row/pair/gray_neon_<colorimetry>
+#define NEON_KERNELS(family, name, ...) \
+    void yuv_row_##family##_##name(const uint8_t *y_row, const uint8_t *u_row, \
+                                   const uint8_t *v_row, uint8_t *dst, int width, \
+                                   ptrdiff_t step) \
+    { \
+        neon_row(y_row, u_row, v_row, dst, width, step, (yuv_coeffs){ __VA_ARGS__ }, \
+                 yuv_row_scalar_##name); \
+    } \
+    void yuv_pair_##family##_##name(const uint8_t *y_row0, const uint8_t *y_row1, \
+                                    const uint8_t *u_row, const uint8_t *v_row, \
+                                    uint8_t *dst0, uint8_t *dst1, int width, \
+                                    ptrdiff_t step) \
+    { \
+        neon_pair(y_row0, y_row1, u_row, v_row, dst0, dst1, width, step, \
+                  (yuv_coeffs){ __VA_ARGS__ }, yuv_pair_scalar_##name); \
+    } \
+    void yuv_gray_##family##_##name(const uint8_t *y_row, uint8_t *dst, int width, \
+                                    ptrdiff_t step) \
+    { \
+        neon_gray(y_row, dst, width, step, (yuv_coeffs){ __VA_ARGS__ }, yuv_gray_scalar_##name); \
+    }
+
+YUV_COLORIMETRIES(NEON_KERNELS, neon)
+
+#endif /* YUV_HAVE_NEON */
@@ -0,0 +1,670 @@
+/******************************************************************************
+* YUV_CONVERT_X86.C
+*
+* x86 kernels for the YUV420 to RGB565 conversion, used when replaying
+* captured .yuv420 files on workstations. Two kernels are provided:
+*   - SSE4.1: 16 pixels per iteration
+*   - AVX2:   32 pixels per iteration
+*
+* Each kernel has a row and a 2x2 block (row pair) entry point; the pair
+* versions compute the chroma terms once for both luma rows. Mirrored rows
+* are reversed with a word shuffle before the store, and rotated rows are
+* stored one pixel per output row (sse_store_pixels). The grayscale
+* kernels run the luma half of the same arithmetic and share the packing
+* and stores. The SSE4.1
+* byte-shuffle split helpers for NV12/NV21 and YUYV input serve both; the
+* downscaler's vertical pass has its own SSE4.1 and AVX2 versions.
+*
+* Both use the same 16-bit formula split as the NEON kernel (see
+* yuv_kernels.h) and give output bit-identical to the scalar kernels. The
+* kernel bodies take the colorimetry coefficients as constants and are
+* instantiated once per colorimetry at the end of the file. Each
+* function carries its own target attribute, so the file builds with the
+* default compiler flags and the right kernel is chosen at runtime by the
+* CPU probe in yuv_convert.c.
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "yuv_kernels.h"
+
+#ifdef YUV_HAVE_X86
+#include <immintrin.h>
+#include <string.h>
+
+#define SSE41 __attribute__((target("sse4.1")))
+#define AVX2  __attribute__((target("avx2")))
+
+// Chroma terms for 16 pixels (SSE) or 32 pixels (AVX2), duplicated onto
+// both pixels of a pair; [0] covers the first half, [1] the second
+typedef struct
+{
+    __m128i r_base[2], g_base[2], b_base[2];
+    __m128i r_frac[2], g_frac[2], b_frac[2];
+} sse_chroma;
+
+typedef struct
+{
+    __m256i r_base[2], g_base[2], b_base[2];
+    __m256i r_frac[2], g_frac[2], b_frac[2];
+} avx_chroma;
+
+/******************************************************************************
+* function: sse_chroma_terms
+* brief: Compute the chroma terms for 8 U/V pairs (16 pixels)
+*
+* Unpacking a term with itself duplicates it onto both pixels of the pair.
+******************************************************************************/
+YUV_INLINE SSE41 void sse_chroma_terms(const uint8_t *u_ptr, const uint8_t *v_ptr, sse_chroma *t,
+                                       yuv_coeffs k)
+{
+    const __m128i k128 = _mm_set1_epi16(128);
+
+    __m128i d = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)u_ptr)), k128);
+    __m128i e = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)v_ptr)), k128);
+
+    __m128i r_frac = _mm_add_epi16(k128, _mm_mullo_epi16(e, _mm_set1_epi16(YUV_FRAC(k.r_v))));
+    __m128i g_frac = _mm_add_epi16(k128, _mm_add_epi16(_mm_mullo_epi16(d, _mm_set1_epi16(YUV_FRAC(k.g_u))),
+                                                       _mm_mullo_epi16(e, _mm_set1_epi16(YUV_FRAC(k.g_v)))));
+    __m128i b_frac = _mm_add_epi16(k128, _mm_mullo_epi16(d, _mm_set1_epi16(YUV_FRAC(k.b_u))));
+    __m128i r_base = _mm_mullo_epi16(e, _mm_set1_epi16(YUV_WHOLE(k.r_v)));
+    __m128i g_base = _mm_add_epi16(_mm_mullo_epi16(d, _mm_set1_epi16(YUV_WHOLE(k.g_u))),
+                                   _mm_mullo_epi16(e, _mm_set1_epi16(YUV_WHOLE(k.g_v))));
+    __m128i b_base = _mm_mullo_epi16(d, _mm_set1_epi16(YUV_WHOLE(k.b_u)));
+
+    t->r_base[0] = _mm_unpacklo_epi16(r_base, r_base);
+    t->r_base[1] = _mm_unpackhi_epi16(r_base, r_base);
+    t->g_base[0] = _mm_unpacklo_epi16(g_base, g_base);
+    t->g_base[1] = _mm_unpackhi_epi16(g_base, g_base);
+    t->b_base[0] = _mm_unpacklo_epi16(b_base, b_base);
+    t->b_base[1] = _mm_unpackhi_epi16(b_base, b_base);
+    t->r_frac[0] = _mm_unpacklo_epi16(r_frac, r_frac);
+    t->r_frac[1] = _mm_unpackhi_epi16(r_frac, r_frac);
+    t->g_frac[0] = _mm_unpacklo_epi16(g_frac, g_frac);
+    t->g_frac[1] = _mm_unpackhi_epi16(g_frac, g_frac);
+    t->b_frac[0] = _mm_unpacklo_epi16(b_frac, b_frac);
+    t->b_frac[1] = _mm_unpackhi_epi16(b_frac, b_frac);
+}
+
+/******************************************************************************
+* function: sse_channel
+* brief: Finish one color channel for 16 pixels and saturate to 8 bits
+******************************************************************************/
+static inline SSE41 __m128i sse_channel(__m128i lc_lo, __m128i lc_hi, __m128i lf_lo, __m128i lf_hi,
+                                        const __m128i base[2], const __m128i frac[2])
+{
+    __m128i lo = _mm_add_epi16(_mm_add_epi16(lc_lo, base[0]),
+                               _mm_srai_epi16(_mm_add_epi16(lf_lo, frac[0]), 8));
+    __m128i hi = _mm_add_epi16(_mm_add_epi16(lc_hi, base[1]),
+                               _mm_srai_epi16(_mm_add_epi16(lf_hi, frac[1]), 8));
+    return _mm_packus_epi16(lo, hi);
+}
+
+// Store pixel 'i' of a vector of 8 RGB565 pixels (already in byte order)
+#define SSE_STORE_PIXEL(px, i, dst, step) \
+    do \
+    { \
+        uint16_t pixel = (uint16_t)_mm_extract_epi16(px, i); \
+        memcpy((dst) + (i) * (step), &pixel, 2); \
+    } while (0)
+
+/******************************************************************************
+* function: sse_store_pixels
+* brief: Store 16 RGB565 pixels (p0 = pixels 0..7, p1 = 8..15) 'step' bytes
+*        apart
+*
+* Step 2 is the plain row store. For step -2 (mirrored row) the pixels end
+* at dst, so the reversed vectors are stored below it. Any other step puts
+* each pixel in its own output row (rotated output).
+******************************************************************************/
+static inline SSE41 void sse_store_pixels(__m128i p0, __m128i p1, uint8_t *dst, ptrdiff_t step)
+{
+    if (step == YUV_STEP_FORWARD)
+    {
+        _mm_storeu_si128((__m128i *)dst, p0);
+        _mm_storeu_si128((__m128i *)(dst + 16), p1);
+    }
+    else if (step == YUV_STEP_REVERSE)
+    {
+        const __m128i reverse = _mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+
+        _mm_storeu_si128((__m128i *)(dst - 30), _mm_shuffle_epi8(p1, reverse));
+        _mm_storeu_si128((__m128i *)(dst - 14), _mm_shuffle_epi8(p0, reverse));
+    }
+    else
+    {
+        uint8_t *hi = dst + 8 * step;
+
+        SSE_STORE_PIXEL(p0, 0, dst, step);
+        SSE_STORE_PIXEL(p0, 1, dst, step);
+        SSE_STORE_PIXEL(p0, 2, dst, step);
+        SSE_STORE_PIXEL(p0, 3, dst, step);
+        SSE_STORE_PIXEL(p0, 4, dst, step);
+        SSE_STORE_PIXEL(p0, 5, dst, step);
+        SSE_STORE_PIXEL(p0, 6, dst, step);
+        SSE_STORE_PIXEL(p0, 7, dst, step);
+        SSE_STORE_PIXEL(p1, 0, hi, step);
+        SSE_STORE_PIXEL(p1, 1, hi, step);
+        SSE_STORE_PIXEL(p1, 2, hi, step);
+        SSE_STORE_PIXEL(p1, 3, hi, step);
+        SSE_STORE_PIXEL(p1, 4, hi, step);
+        SSE_STORE_PIXEL(p1, 5, hi, step);
+        SSE_STORE_PIXEL(p1, 6, hi, step);
+        SSE_STORE_PIXEL(p1, 7, hi, step);
+    }
+}
+
+/******************************************************************************
+* function: sse_pack_store
+* brief: Pack 16 pixels of 8-bit RGB to big-endian RGB565 and store them
+******************************************************************************/
+static inline SSE41 void sse_pack_store(__m128i r, __m128i g, __m128i b, uint8_t *dst, ptrdiff_t step)
+{
+    // Pack RGB565: high = RRRRRGGG, low = GGGBBBBB
+    __m128i hi = _mm_or_si128(_mm_and_si128(r, _mm_set1_epi8((char)0xF8)),
+                              _mm_and_si128(_mm_srli_epi16(g, 5), _mm_set1_epi8(0x07)));
+    __m128i lo = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(g, 3), _mm_set1_epi8((char)0xE0)),
+                              _mm_and_si128(_mm_srli_epi16(b, 3), _mm_set1_epi8(0x1F)));
+
+    sse_store_pixels(_mm_unpacklo_epi8(hi, lo), _mm_unpackhi_epi8(hi, lo), dst, step);
+}
+
+/******************************************************************************
+* function: sse_luma_store
+* brief: Apply the chroma terms to 16 luma samples and store RGB565
+******************************************************************************/
+YUV_INLINE SSE41 void sse_luma_store(const uint8_t *y_ptr, const sse_chroma *t, uint8_t *dst,
+                                     ptrdiff_t step, yuv_coeffs k)
+{
+    const __m128i y_offset = _mm_set1_epi16(k.y_offset);
+    __m128i y = _mm_loadu_si128((const __m128i *)y_ptr);
+
+    // c = y - y_offset, split into whole and fractional gain parts
+    __m128i c_lo = _mm_sub_epi16(_mm_cvtepu8_epi16(y), y_offset);
+    __m128i c_hi = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(y, 8)), y_offset);
+    __m128i lc_lo = _mm_mullo_epi16(c_lo, _mm_set1_epi16(YUV_WHOLE(k.y_gain)));
+    __m128i lc_hi = _mm_mullo_epi16(c_hi, _mm_set1_epi16(YUV_WHOLE(k.y_gain)));
+    __m128i lf_lo = _mm_mullo_epi16(c_lo, _mm_set1_epi16(YUV_FRAC(k.y_gain)));
+    __m128i lf_hi = _mm_mullo_epi16(c_hi, _mm_set1_epi16(YUV_FRAC(k.y_gain)));
+
+    __m128i r = sse_channel(lc_lo, lc_hi, lf_lo, lf_hi, t->r_base, t->r_frac);
+    __m128i g = sse_channel(lc_lo, lc_hi, lf_lo, lf_hi, t->g_base, t->g_frac);
+    __m128i b = sse_channel(lc_lo, lc_hi, lf_lo, lf_hi, t->b_base, t->b_frac);
+
+    sse_pack_store(r, g, b, dst, step);
+}
+
+/******************************************************************************
+* function: sse_gray
+* brief: SSE4.1 grayscale kernel body, 16 pixels per iteration
+*
+* The luma term of sse_luma_store with zero chroma terms and the rounding
+* bias as the remainder.
+******************************************************************************/
+YUV_INLINE SSE41 void sse_gray(const uint8_t *y_row, uint8_t *dst, int width,
+                               ptrdiff_t step, yuv_coeffs k, yuv_gray_fn tail)
+{
+    const __m128i y_offset = _mm_set1_epi16(k.y_offset);
+    const __m128i base[2] = { _mm_setzero_si128(), _mm_setzero_si128() };
+    const __m128i frac[2] = { _mm_set1_epi16(128), _mm_set1_epi16(128) };
+    int col = 0;
+
+    for (; col + 16 <= width; col += 16)
+    {
+        __m128i y = _mm_loadu_si128((const __m128i *)(y_row + col));
+        __m128i c_lo = _mm_sub_epi16(_mm_cvtepu8_epi16(y), y_offset);
+        __m128i c_hi = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(y, 8)), y_offset);
+        __m128i v = sse_channel(_mm_mullo_epi16(c_lo, _mm_set1_epi16(YUV_WHOLE(k.y_gain))),
+                                _mm_mullo_epi16(c_hi, _mm_set1_epi16(YUV_WHOLE(k.y_gain))),
+                                _mm_mullo_epi16(c_lo, _mm_set1_epi16(YUV_FRAC(k.y_gain))),
+                                _mm_mullo_epi16(c_hi, _mm_set1_epi16(YUV_FRAC(k.y_gain))),
+                                base, frac);
+
+        sse_pack_store(v, v, v, dst + col * step, step);
+    }
+
+    if (col < width)
+    {
+        tail(y_row + col, dst + col * step, width - col, step);
+    }
+}
+
+/******************************************************************************
+* function: sse_row
+* brief: SSE4.1 row kernel body, 16 pixels per iteration
+******************************************************************************/
+YUV_INLINE SSE41 void sse_row(const uint8_t *y_row, const uint8_t *u_row,
+                              const uint8_t *v_row, uint8_t *dst, int width,
+                              ptrdiff_t step, yuv_coeffs k, yuv_row_fn tail)
+{
+    sse_chroma t;
+    int col = 0;
+
+    for (; col + 16 <= width; col += 16)
+    {
+        sse_chroma_terms(u_row + (col >> 1), v_row + (col >> 1), &t, k);
+        sse_luma_store(y_row + col, &t, dst + col * step, step, k);
+    }
+
+    if (col < width)
+    {
+        tail(y_row + col, u_row + (col >> 1), v_row + (col >> 1),
+             dst + col * step, width - col, step);
+    }
+}
+
+/******************************************************************************
+* function: sse_pair
+* brief: SSE4.1 2x2 block kernel body, 16x2 pixels per iteration
+******************************************************************************/
+YUV_INLINE SSE41 void sse_pair(const uint8_t *y_row0, const uint8_t *y_row1,
+                               const uint8_t *u_row, const uint8_t *v_row,
+                               uint8_t *dst0, uint8_t *dst1, int width,
+                               ptrdiff_t step, yuv_coeffs k, yuv_pair_fn tail)
+{
+    sse_chroma t;
+    int col = 0;
+
+    for (; col + 16 <= width; col += 16)
+    {
+        sse_chroma_terms(u_row + (col >> 1), v_row + (col >> 1), &t, k);
+        sse_luma_store(y_row0 + col, &t, dst0 + col * step, step, k);
+        sse_luma_store(y_row1 + col, &t, dst1 + col * step, step, k);
+    }
+
+    if (col < width)
+    {
+        tail(y_row0 + col, y_row1 + col, u_row + (col >> 1), v_row + (col >> 1),
+             dst0 + col * step, dst1 + col * step, width - col, step);
+    }
+}
+
+/******************************************************************************
+* function: avx_dup_pairs
+* brief: Duplicate 16 chroma terms onto 32 pixels
+*
+* AVX2 unpacks work per 128-bit lane, so the lanes are reassembled to give
+* pixels 0..15 in out[0] and 16..31 in out[1].
+******************************************************************************/
+static inline AVX2 void avx_dup_pairs(__m256i t, __m256i out[2])
+{
+    __m256i lo = _mm256_unpacklo_epi16(t, t);
+    __m256i hi = _mm256_unpackhi_epi16(t, t);
+    out[0] = _mm256_permute2x128_si256(lo, hi, 0x20);
+    out[1] = _mm256_permute2x128_si256(lo, hi, 0x31);
+}
+
+/******************************************************************************
+* function: avx_chroma_terms
+* brief: Compute the chroma terms for 16 U/V pairs (32 pixels)
+******************************************************************************/
+YUV_INLINE AVX2 void avx_chroma_terms(const uint8_t *u_ptr, const uint8_t *v_ptr, avx_chroma *t,
+                                      yuv_coeffs k)
+{
+    const __m256i k128 = _mm256_set1_epi16(128);
+
+    __m256i d = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)u_ptr)), k128);
+    __m256i e = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)v_ptr)), k128);
+
+    __m256i r_frac = _mm256_add_epi16(k128, _mm256_mullo_epi16(e, _mm256_set1_epi16(YUV_FRAC(k.r_v))));
+    __m256i g_frac = _mm256_add_epi16(k128, _mm256_add_epi16(_mm256_mullo_epi16(d, _mm256_set1_epi16(YUV_FRAC(k.g_u))),
+                                                             _mm256_mullo_epi16(e, _mm256_set1_epi16(YUV_FRAC(k.g_v)))));
+    __m256i b_frac = _mm256_add_epi16(k128, _mm256_mullo_epi16(d, _mm256_set1_epi16(YUV_FRAC(k.b_u))));
+    __m256i r_base = _mm256_mullo_epi16(e, _mm256_set1_epi16(YUV_WHOLE(k.r_v)));
+    __m256i g_base = _mm256_add_epi16(_mm256_mullo_epi16(d, _mm256_set1_epi16(YUV_WHOLE(k.g_u))),
+                                      _mm256_mullo_epi16(e, _mm256_set1_epi16(YUV_WHOLE(k.g_v))));
+    __m256i b_base = _mm256_mullo_epi16(d, _mm256_set1_epi16(YUV_WHOLE(k.b_u)));
+
+    avx_dup_pairs(r_base, t->r_base);
+    avx_dup_pairs(g_base, t->g_base);
+    avx_dup_pairs(b_base, t->b_base);
+    avx_dup_pairs(r_frac, t->r_frac);
+    avx_dup_pairs(g_frac, t->g_frac);
+    avx_dup_pairs(b_frac, t->b_frac);
+}
+
+/******************************************************************************
+* function: avx_channel
+* brief: Finish one color channel for 32 pixels and saturate to 8 bits
+*
+* The result is in packus lane order (0..7, 16..23 | 8..15, 24..31), which
+* the byte interleave in avx_luma_store turns back into pixel order.
+******************************************************************************/
+static inline AVX2 __m256i avx_channel(__m256i lc_lo, __m256i lc_hi, __m256i lf_lo, __m256i lf_hi,
+                                       const __m256i base[2], const __m256i frac[2])
+{
+    __m256i lo = _mm256_add_epi16(_mm256_add_epi16(lc_lo, base[0]),
+                                  _mm256_srai_epi16(_mm256_add_epi16(lf_lo, frac[0]), 8));
+    __m256i hi = _mm256_add_epi16(_mm256_add_epi16(lc_hi, base[1]),
+                                  _mm256_srai_epi16(_mm256_add_epi16(lf_hi, frac[1]), 8));
+    return _mm256_packus_epi16(lo, hi);
+}
+
+/******************************************************************************
+* function: avx_pack_store
+* brief: Pack 32 pixels of 8-bit RGB (in packus lane order) to big-endian
+*        RGB565 and store them
+******************************************************************************/
+static inline AVX2 void avx_pack_store(__m256i r, __m256i g, __m256i b, uint8_t *dst, ptrdiff_t step)
+{
+    __m256i hi = _mm256_or_si256(_mm256_and_si256(r, _mm256_set1_epi8((char)0xF8)),
+                                 _mm256_and_si256(_mm256_srli_epi16(g, 5), _mm256_set1_epi8(0x07)));
+    __m256i lo = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(g, 3), _mm256_set1_epi8((char)0xE0)),
+                                 _mm256_and_si256(_mm256_srli_epi16(b, 3), _mm256_set1_epi8(0x1F)));
+
+    // Per-lane interleave undoes the packus lane order: pixels 0..15, then 16..31
+    __m256i p0 = _mm256_unpacklo_epi8(hi, lo);
+    __m256i p1 = _mm256_unpackhi_epi8(hi, lo);
+
+    if (step == YUV_STEP_FORWARD)
+    {
+        _mm256_storeu_si256((__m256i *)dst, p0);
+        _mm256_storeu_si256((__m256i *)(dst + 32), p1);
+    }
+    else
+    {
+        sse_store_pixels(_mm256_castsi256_si128(p0), _mm256_extracti128_si256(p0, 1), dst, step);
+        sse_store_pixels(_mm256_castsi256_si128(p1), _mm256_extracti128_si256(p1, 1),
+                         dst + 16 * step, step);
+    }
+}
+
+/******************************************************************************
+* function: avx_luma_store
+* brief: Apply the chroma terms to 32 luma samples and store RGB565
+******************************************************************************/
+YUV_INLINE AVX2 void avx_luma_store(const uint8_t *y_ptr, const avx_chroma *t, uint8_t *dst,
+                                    ptrdiff_t step, yuv_coeffs k)
+{
+    const __m256i y_offset = _mm256_set1_epi16(k.y_offset);
+    __m256i y = _mm256_loadu_si256((const __m256i *)y_ptr);
+
+    __m256i c_lo = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(y)), y_offset);
+    __m256i c_hi = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(y, 1)), y_offset);
+    __m256i lc_lo = _mm256_mullo_epi16(c_lo, _mm256_set1_epi16(YUV_WHOLE(k.y_gain)));
+    __m256i lc_hi = _mm256_mullo_epi16(c_hi, _mm256_set1_epi16(YUV_WHOLE(k.y_gain)));
+    __m256i lf_lo = _mm256_mullo_epi16(c_lo, _mm256_set1_epi16(YUV_FRAC(k.y_gain)));
+    __m256i lf_hi = _mm256_mullo_epi16(c_hi, _mm256_set1_epi16(YUV_FRAC(k.y_gain)));
+
+    __m256i r = avx_channel(lc_lo, lc_hi, lf_lo, lf_hi, t->r_base, t->r_frac);
+    __m256i g = avx_channel(lc_lo, lc_hi, lf_lo, lf_hi, t->g_base, t->g_frac);
+    __m256i b = avx_channel(lc_lo, lc_hi, lf_lo, lf_hi, t->b_base, t->b_frac);
+
+    avx_pack_store(r, g, b, dst, step);
+}
+
+/******************************************************************************
+* function: avx_gray
+* brief: AVX2 grayscale kernel body, 32 pixels per iteration
+******************************************************************************/
+YUV_INLINE AVX2 void avx_gray(const uint8_t *y_row, uint8_t *dst, int width,
+                              ptrdiff_t step, yuv_coeffs k, yuv_gray_fn tail)
+{
+    const __m256i y_offset = _mm256_set1_epi16(k.y_offset);
+    const __m256i base[2] = { _mm256_setzero_si256(), _mm256_setzero_si256() };
+    const __m256i frac[2] = { _mm256_set1_epi16(128), _mm256_set1_epi16(128) };
+    int col = 0;
+
+    for (; col + 32 <= width; col += 32)
+    {
+        __m256i y = _mm256_loadu_si256((const __m256i *)(y_row + col));
+        __m256i c_lo = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(y)), y_offset);
+        __m256i c_hi = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(y, 1)), y_offset);
+        __m256i v = avx_channel(_mm256_mullo_epi16(c_lo, _mm256_set1_epi16(YUV_WHOLE(k.y_gain))),
+                                _mm256_mullo_epi16(c_hi, _mm256_set1_epi16(YUV_WHOLE(k.y_gain))),
+                                _mm256_mullo_epi16(c_lo, _mm256_set1_epi16(YUV_FRAC(k.y_gain))),
+                                _mm256_mullo_epi16(c_hi, _mm256_set1_epi16(YUV_FRAC(k.y_gain))),
+                                base, frac);
+
+        avx_pack_store(v, v, v, dst + col * step, step);
+    }
+
+    if (col < width)
+    {
+        tail(y_row + col, dst + col * step, width - col, step);
+    }
+}
+
+/******************************************************************************
+* function: avx_row
+* brief: AVX2 row kernel body, 32 pixels per iteration
+******************************************************************************/
+YUV_INLINE AVX2 void avx_row(const uint8_t *y_row, const uint8_t *u_row,
+                             const uint8_t *v_row, uint8_t *dst, int width,
+                             ptrdiff_t step, yuv_coeffs k, yuv_row_fn tail)
+{
+    avx_chroma t;
+    int col = 0;
+
+    for (; col + 32 <= width; col += 32)
+    {
+        avx_chroma_terms(u_row + (col >> 1), v_row + (col >> 1), &t, k);
+        avx_luma_store(y_row + col, &t, dst + col * step, step, k);
+    }
+
+    if (col < width)
+    {
+        tail(y_row + col, u_row + (col >> 1), v_row + (col >> 1),
+             dst + col * step, width - col, step);
+    }
+}
+
+/******************************************************************************
+* function: avx_pair
+* brief: AVX2 2x2 block kernel body, 32x2 pixels per iteration
+******************************************************************************/
+YUV_INLINE AVX2 void avx_pair(const uint8_t *y_row0, const uint8_t *y_row1,
+                              const uint8_t *u_row, const uint8_t *v_row,
+                              uint8_t *dst0, uint8_t *dst1, int width,
+                              ptrdiff_t step, yuv_coeffs k, yuv_pair_fn tail)
+{
+    avx_chroma t;
+    int col = 0;
+
+    for (; col + 32 <= width; col += 32)
+    {
+        avx_chroma_terms(u_row + (col >> 1), v_row + (col >> 1), &t, k);
+        avx_luma_store(y_row0 + col, &t, dst0 + col * step, step, k);
+        avx_luma_store(y_row1 + col, &t, dst1 + col * step, step, k);
+    }
+
+    if (col < width)
+    {
+        tail(y_row0 + col, y_row1 + col, u_row + (col >> 1), v_row + (col >> 1),
+             dst0 + col * step, dst1 + col * step, width - col, step);
+    }
+}
+
+/******************************************************************************
+* function: yuv_split_uv_sse41
+* brief: Split interleaved chroma into two rows, 16 pairs per iteration
+******************************************************************************/
+SSE41 void yuv_split_uv_sse41(const uint8_t *uv, uint8_t *first, uint8_t *second, int pairs)
+{
+    // Even bytes to the low half, odd bytes to the high half
+    const __m128i split = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    int i = 0;
+
+    for (; i + 16 <= pairs; i += 16)
+    {
+        __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(uv + 2 * i)), split);
+        __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(uv + 2 * i + 16)), split);
+        _mm_storeu_si128((__m128i *)(first + i), _mm_unpacklo_epi64(a, b));
+        _mm_storeu_si128((__m128i *)(second + i), _mm_unpackhi_epi64(a, b));
+    }
+
+    if (i < pairs)
+    {
+        yuv_split_uv_scalar(uv + 2 * i, first + i, second + i, pairs - i);
+    }
+}
+
+/******************************************************************************
+* function: yuv_split_yuyv_sse41
+* brief: Split packed YUYV into Y, U and V rows, 16 pixels per iteration
+******************************************************************************/
+SSE41 void yuv_split_yuyv_sse41(const uint8_t *yuyv, uint8_t *y, uint8_t *u, uint8_t *v, int width)
+{
+    // Per 8 pixels: Y0..Y7 in the low half, then U0..U3 and V0..V3
+    const __m128i split = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 5, 9, 13, 3, 7, 11, 15);
+    int col = 0;
+
+    for (; col + 16 <= width; col += 16)
+    {
+        __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(yuyv + 2 * col)), split);
+        __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(yuyv + 2 * col + 16)), split);
+        __m128i uv = _mm_unpackhi_epi32(a, b);      // U(a) U(b) V(a) V(b)
+
+        _mm_storeu_si128((__m128i *)(y + col), _mm_unpacklo_epi64(a, b));
+        _mm_storel_epi64((__m128i *)(u + (col >> 1)), uv);
+        _mm_storel_epi64((__m128i *)(v + (col >> 1)), _mm_srli_si128(uv, 8));
+    }
+
+    if (col < width)
+    {
+        yuv_split_yuyv_scalar(yuyv + 2 * col, y + col, u + (col >> 1), v + (col >> 1), width - col);
+    }
+}
+
+/******************************************************************************
+* function: yuv_scale_rows_sse41
+* brief: Vertical downscaler pass, 16 bytes per iteration
+*
+* Weights add up to 256, so the 16-bit accumulator tops out at
+* 255 * 256 + 128 and the unsigned lanes never wrap.
+******************************************************************************/
+SSE41 void yuv_scale_rows_sse41(const uint8_t *const *rows, const uint16_t *weights,
+                                int taps, uint8_t *dst, int n)
+{
+    const __m128i bias = _mm_set1_epi16(128);
+    int x = 0;
+
+    for (; x + 16 <= n; x += 16)
+    {
+        __m128i lo = bias;
+        __m128i hi = bias;
+
+        for (int t = 0; t < taps; t++)
+        {
+            __m128i w = _mm_set1_epi16((short)weights[t]);
+            __m128i px = _mm_loadu_si128((const __m128i *)(rows[t] + x));
+            lo = _mm_add_epi16(lo, _mm_mullo_epi16(_mm_cvtepu8_epi16(px), w));
+            hi = _mm_add_epi16(hi, _mm_mullo_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(px, 8)), w));
+        }
+        _mm_storeu_si128((__m128i *)(dst + x),
+                         _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+
+    if (x < n)
+    {
+        const uint8_t *tail[YUV_SCALE_MAX_TAPS];
+
+        for (int t = 0; t < taps; t++)
+        {
+            tail[t] = rows[t] + x;
+        }
+        yuv_scale_rows_scalar(tail, weights, taps, dst + x, n - x);
+    }
+}
+
+/******************************************************************************
+* function: yuv_scale_rows_avx2
+* brief: Vertical downscaler pass, 32 bytes per iteration
+******************************************************************************/
+AVX2 void yuv_scale_rows_avx2(const uint8_t *const *rows, const uint16_t *weights,
+                              int taps, uint8_t *dst, int n)
+{
+    const __m256i bias = _mm256_set1_epi16(128);
+    int x = 0;
+
+    for (; x + 32 <= n; x += 32)
+    {
+        __m256i lo = bias;
+        __m256i hi = bias;
+
+        for (int t = 0; t < taps; t++)
+        {
+            __m256i w = _mm256_set1_epi16((short)weights[t]);
+            __m256i px = _mm256_loadu_si256((const __m256i *)(rows[t] + x));
+            lo = _mm256_add_epi16(lo, _mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(px)), w));
+            hi = _mm256_add_epi16(hi, _mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(px, 1)), w));
+        }
+
+        // packus works per lane; restore byte order across the lanes
+        __m256i packed = _mm256_packus_epi16(_mm256_srli_epi16(lo, 8), _mm256_srli_epi16(hi, 8));
+        _mm256_storeu_si256((__m256i *)(dst + x), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+
+    if (x < n)
+    {
+        const uint8_t *tail[YUV_SCALE_MAX_TAPS];
+
+        for (int t = 0; t < taps; t++)
+        {
+            tail[t] = rows[t] + x;
+        }
+        yuv_scale_rows_sse41(tail, weights, taps, dst + x, n - x);
+    }
+}
+
+// yuv_row/pair/gray_sse41_<colorimetry>, with the scalar kernel for the row tail
+#define SSE41_KERNELS(family, name, ...) \
+    SSE41 void yuv_row_##family##_##name(const uint8_t *y_row, const uint8_t *u_row, \
+                                         const uint8_t *v_row, uint8_t *dst, int width, \
+                                         ptrdiff_t step) \
+    { \
+        sse_row(y_row, u_row, v_row, dst, width, step, (yuv_coeffs){ __VA_ARGS__ }, \
+                yuv_row_scalar_##name); \
+    } \
+    SSE41 void yuv_pair_##family##_##name(const uint8_t *y_row0, const uint8_t *y_row1, \
+                                          const uint8_t *u_row, const uint8_t *v_row, \
+                                          uint8_t *dst0, uint8_t *dst1, int width, \
+                                          ptrdiff_t step) \
+    { \
+        sse_pair(y_row0, y_row1, u_row, v_row, dst0, dst1, width, step, \
+                 (yuv_coeffs){ __VA_ARGS__ }, yuv_pair_scalar_##name); \
+    } \
+    SSE41 void yuv_gray_##family##_##name(const uint8_t *y_row, uint8_t *dst, int width, \
+                                          ptrdiff_t step) \
+    { \
+        sse_gray(y_row, dst, width, step, (yuv_coeffs){ __VA_ARGS__ }, yuv_gray_scalar_##name); \
+    }
+
+// yuv_row/pair/gray_avx2_<colorimetry>, with the SSE4.1 kernel for the row tail
+#define AVX2_KERNELS(family, name, ...) \
+    AVX2 void yuv_row_##family##_##name(const uint8_t *y_row, const uint8_t *u_row, \
+                                        const uint8_t *v_row, uint8_t *dst, int width, \
+                                        ptrdiff_t step) \
+    { \
+        avx_row(y_row, u_row, v_row, dst, width, step, (yuv_coeffs){ __VA_ARGS__ }, \
+                yuv_row_sse41_##name); \
+    } \
+    AVX2 void yuv_pair_##family##_##name(const uint8_t *y_row0, const uint8_t *y_row1, \
+                                         const uint8_t *u_row, const uint8_t *v_row, \
+                                         uint8_t *dst0, uint8_t *dst1, int width, \
+                                         ptrdiff_t step) \
+    { \
+        avx_pair(y_row0, y_row1, u_row, v_row, dst0, dst1, width, step, \
+                 (yuv_coeffs){ __VA_ARGS__ }, yuv_pair_sse41_##name); \
+    } \
+    AVX2 void yuv_gray_##family##_##name(const uint8_t *y_row, uint8_t *dst, int width, \
+                                         ptrdiff_t step) \
+    { \
+        avx_gray(y_row, dst, width, step, (yuv_coeffs){ __VA_ARGS__ }, yuv_gray_sse41_##name); \
+    }
+
+YUV_COLORIMETRIES(SSE41_KERNELS, sse41)
+YUV_COLORIMETRIES(AVX2_KERNELS, avx2)
+
+#endif /* YUV_HAVE_X86 */
@@ -0,0 +1,213 @@
+/******************************************************************************
+* YUV_KERNELS.H
+*
+* Internal declarations shared by the conversion kernels. This header is only
+* included by the yuv_convert*.c files; the rest of the driver goes through
+* yuv_convert.h.
+*
+* All kernels implement the fixed-point formula of yuv420_to_rgb, with the
+* coefficients of the stream's colorimetry (see YUV_COLORIMETRIES below).
+* Every kernel is instantiated once per colorimetry with the coefficients as
+* compile-time constants, so the inner loops carry no matrix lookups or
+* branches; the variant is picked once when a stream starts.
+*
+* Vector kernels evaluate the formula in 16-bit lanes using an exact split
+* of each 8.8 coefficient into a whole part and a remainder in [-128, 127]
+* (298 = 256 + 42, 409 = 512 - 103, ...). For BT.601 limited range:
+*
+*   r = c + 2e + ((42c - 103e + 128) >> 8)
+*   g = c - e  + ((42c - 100d + 48e + 128) >> 8)
+*   b = c + 2d + ((42c + 4d + 128) >> 8)
+*
+* with c = y - y_offset, d = u - 128, e = v - 128. Because the split-off
+* parts are multiples of 256 the arithmetic shift gives bit-identical
+* results to the 32-bit reference formula, and for all four coefficient
+* sets every remainder sum fits in int16 for any 8-bit input.
+*
+* Kernels write pixel i of a row at dst + i * step. Vector kernels keep
+* their full-width stores for step 2, reverse the pixels in registers for
+* step -2 (mirrored output) and store each pixel on its own for any other
+* step (rotated output, one pixel per output row).
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+*
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#ifndef YUV_KERNELS_H
+#define YUV_KERNELS_H
+
+#include <stdint.h>
+#include "yuv_convert.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define YUV_HAVE_NEON 1
+#endif
+
+// x86 kernels are built with per-function target attributes and picked by a
+// CPU probe at startup, so no special compiler flags are needed
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define YUV_HAVE_X86 1
+#endif
+
+// Pack 8-bit RGB into one big-endian RGB565 pixel (high byte first)
+static inline void yuv_put_rgb565(uint8_t *dst, uint8_t r, uint8_t g, uint8_t b)
+{
+    dst[0] = (r & 0xF8) | (g >> 5);
+    dst[1] = ((g & 0x1C) << 3) | (b >> 3);
+}
+
+// Saturate to [0, 255]
+static inline uint8_t yuv_clamp8(int x)
+{
+    return (x < 0) ? 0 : ((x > 255) ? 255 : x);
+}
+
+// Colorimetry variants in yuv_colorimetry_t order:
+//   X(arg, name, y_offset, y_gain, r_v, g_u, g_v, b_u)
+// 'arg' is passed through for the caller; the gains are 8.8 fixed point for
+// luma and for chroma centered on 128.
+#define YUV_COLORIMETRIES(X, arg) \
+    X(arg, bt601_limited, 16, 298, 409, -100, -208, 516) \
+    X(arg, bt601_full,     0, 256, 359,  -88, -183, 454) \
+    X(arg, bt709_limited, 16, 298, 459,  -55, -136, 541) \
+    X(arg, bt709_full,     0, 256, 403,  -48, -120, 475)
+
+// One colorimetry's coefficients; only ever built from literal constants
+// inside an instantiation so the compiler folds them into the kernel
+typedef struct
+{
+    int y_offset;
+    int y_gain;
+    int r_v;
+    int g_u;
+    int g_v;
+    int b_u;
+} yuv_coeffs;
+
+// Exact split of an 8.8 coefficient: k = 256 * YUV_WHOLE(k) + YUV_FRAC(k)
+#define YUV_WHOLE(k) (((k) + 128) >> 8)
+#define YUV_FRAC(k)  ((k) - 256 * YUV_WHOLE(k))
+
+// Force the generic kernel bodies into each instantiation
+#define YUV_INLINE static inline __attribute__((always_inline))
+
+// Row kernels convert a single row; pair kernels convert the two rows that
+// share a chroma row (2x2 blocks) and compute the U/V terms only once; gray
+// kernels expand luma alone. Each family 'f' provides yuv_row_f_<colorimetry>,
+// yuv_pair_f_<colorimetry> and yuv_gray_f_<colorimetry>.
+#define YUV_DECLARE_KERNELS(family, name, ...) \
+    void yuv_row_##family##_##name(const uint8_t *y_row, const uint8_t *u_row, \
+                                   const uint8_t *v_row, uint8_t *dst, int width, \
+                                   ptrdiff_t step); \
+    void yuv_pair_##family##_##name(const uint8_t *y_row0, const uint8_t *y_row1, \
+                                    const uint8_t *u_row, const uint8_t *v_row, \
+                                    uint8_t *dst0, uint8_t *dst1, int width, \
+                                    ptrdiff_t step); \
+    void yuv_gray_##family##_##name(const uint8_t *y_row, uint8_t *dst, int width, \
+                                    ptrdiff_t step);
+
+// Output step of a contiguous left-to-right row; other steps come from the
+// orientation
+#define YUV_STEP_FORWARD  2
+#define YUV_STEP_REVERSE -2
+
+// Deinterleave helpers for semi-planar and packed input. split_uv splits
+// 'pairs' interleaved chroma pairs into two rows (NV21 just swaps the
+// outputs); split_yuyv splits 'width' packed YUYV pixels into Y, U and V.
+typedef void (*yuv_split_uv_fn)(const uint8_t *uv, uint8_t *first, uint8_t *second, int pairs);
+typedef void (*yuv_split_yuyv_fn)(const uint8_t *yuyv, uint8_t *y, uint8_t *u, uint8_t *v, int width);
+
+// Most source rows or samples one downscaler output can read: a 16:1 axis
+// spans 17 samples, and YUYV chroma is reduced twice as much vertically
+#define YUV_SCALE_MAX_TAPS (2 * YUV_SCALE_MAX_RATIO + 2)
+
+// Vertical resampling pass of the downscaler: dst[x] is the weighted sum of
+// rows[0..taps-1][x] with 8-bit fixed-point weights that add up to 256
+typedef void (*yuv_scale_rows_fn)(const uint8_t *const *rows, const uint16_t *weights,
+                                  int taps, uint8_t *dst, int n);
+
+#define YUV_DECLARE_SPLIT(family) \
+    void yuv_split_uv_##family(const uint8_t *uv, uint8_t *first, uint8_t *second, int pairs); \
+    void yuv_split_yuyv_##family(const uint8_t *yuyv, uint8_t *y, uint8_t *u, uint8_t *v, int width); \
+    void yuv_scale_rows_##family(const uint8_t *const *rows, const uint16_t *weights, \
+                                 int taps, uint8_t *dst, int n);
+
+#ifdef YUV_HAVE_X86
+void yuv_scale_rows_avx2(const uint8_t *const *rows, const uint16_t *weights,
+                         int taps, uint8_t *dst, int n);
+#endif
+
+// Kernels of the active kernel family and colorimetry, the active
+// orientation and the grayscale switch, resolved once per frame by
+// yuv_frame_kernels_get (yuv_convert.c)
+typedef struct
+{
+    yuv_row_fn row;
+    yuv_pair_fn pair;
+    yuv_gray_fn gray;           // NULL unless grayscale mode is on
+    yuv_split_uv_fn split_uv;
+    yuv_split_yuyv_fn split_yuyv;
+    yuv_scale_rows_fn scale_rows;
+    yuv_orientation_t orientation;
+} yuv_frame_kernels;
+
+void yuv_frame_kernels_get(yuv_frame_kernels *kernels);
+
+// Output addressing of an oriented picture: pixel (x, y) of the unrotated
+// width x height picture goes to origin + y * row_step + x * col_step
+typedef struct
+{
+    uint8_t *origin;
+    ptrdiff_t row_step;
+    ptrdiff_t col_step;
+} yuv_output;
+
+void yuv_output_setup(yuv_output *out, uint8_t *dst, int width, int height,
+                      yuv_orientation_t orientation);
+
+// Luma histogram of one band, filled as the band converts its rows. Four
+// sub-histograms take alternate samples so repeated values do not chain on
+// one counter (yuv_stats.c).
+typedef struct
+{
+    uint32_t bins[4][256];
+} yuv_band_histogram;
+
+// Luma histogram of a frame in progress, merged from its bands
+typedef struct
+{
+    uint32_t bins[256];
+} yuv_frame_histogram;
+
+void yuv_histogram_clear(yuv_band_histogram *band);
+void yuv_histogram_count(yuv_band_histogram *band, const uint8_t *y, int n);
+void yuv_histogram_merge(yuv_frame_histogram *frame, const yuv_band_histogram *band);
+void yuv_histogram_publish(const yuv_frame_histogram *frame);
+
+YUV_DECLARE_SPLIT(scalar)
+YUV_COLORIMETRIES(YUV_DECLARE_KERNELS, scalar)
+YUV_COLORIMETRIES(YUV_DECLARE_KERNELS, lut)
+
+#ifdef YUV_HAVE_NEON
+YUV_DECLARE_SPLIT(neon)
+YUV_COLORIMETRIES(YUV_DECLARE_KERNELS, neon)
+#endif
+
+#ifdef YUV_HAVE_X86
+YUV_DECLARE_SPLIT(sse41)
+YUV_COLORIMETRIES(YUV_DECLARE_KERNELS, sse41)
+YUV_COLORIMETRIES(YUV_DECLARE_KERNELS, avx2)
+#endif
+
+#endif /* YUV_KERNELS_H */
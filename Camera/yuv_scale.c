@@ -0,0 +1,395 @@
+/******************************************************************************
+* YUV_SCALE.C
+*
+* Area-averaging downscaler fused with the YUV to RGB565 conversion. Each
+* output sample is the average of the source samples its footprint covers,
+* weighted by the covered fraction in 8-bit fixed point (weights per output
+* add up to exactly 256).
+*
+* The filter is separable and runs per pair of output rows:
+*   - vertical pass: the source rows under each output row are blended into
+*     one scratch row, byte by byte, with the SIMD pass of the active kernel
+*     family. It does not care about the layout, so interleaved chroma and
+*     packed YUYV rows are blended as they are.
+*   - horizontal pass: each component is picked out of the scratch row with
+*     its byte step and offset and reduced to the output width. This also
+*     deinterleaves NV12/NV21/YUYV for free.
+* The two luma rows and the chroma row then go straight to the 2x2 block
+* kernel, so the only intermediate data is a few rows that stay in L1. The
+* kernel writes them in the active orientation; a transposed picture is
+* scaled to the rotated size so it fills the output after rotation.
+*
+* Most of the work is in the vertical pass (every source byte once); the
+* horizontal pass only sees rows already reduced in height.
+*
+* The luma statistics count the scaled luma rows as they go to the kernel,
+* i.e. the picture as shown, not the source pixels under it.
+*
+* Dependencies:
+*   - convert_pool.h - band-parallel execution
+*   - pthread.h - serializes callers around the shared filter tables
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "yuv_convert.h"
+#include "yuv_kernels.h"
+#include "convert_pool.h"
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+// Resampling filter for one axis: output i reads 'taps' consecutive source
+// samples from start[i] on, weighted by weight[i][]
+typedef struct
+{
+    int src;                    // source samples covered (0 = not built)
+    int out;                    // output samples
+    int taps;
+    int start[YUV_SCALE_MAX_OUT];
+    uint16_t weight[YUV_SCALE_MAX_OUT][YUV_SCALE_MAX_TAPS];
+} scale_filter;
+
+// Source rows read by the vertical pass
+typedef struct
+{
+    const uint8_t *base;        // crop origin in the plane's first row
+    int stride;                 // bytes per source row
+    int span;                   // bytes per row covered by the crop
+} scale_plane;
+
+// Where one chroma component sits in a vertically blended row
+typedef struct
+{
+    int plane;                  // index into the chroma planes
+    int offset;                 // byte of the first sample
+    int step;                   // bytes between samples
+} scale_sample;
+
+// Filters (rebuilt only when the crop or output size changes) and the
+// current job, all protected by 'lock' for the duration of a frame
+static struct
+{
+    pthread_mutex_t lock;
+    scale_filter luma_h;
+    scale_filter luma_v;
+    scale_filter chroma_h;
+    scale_filter chroma_v;
+
+    yuv_frame_kernels k;
+    scale_plane luma;
+    int luma_step;
+    scale_plane chroma[2];
+    int chroma_planes;
+    scale_sample u;
+    scale_sample v;
+    yuv_output out;
+    int out_width;              // scaled width before orientation
+    yuv_frame_histogram luma_hist;
+} scaler =
+{
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/******************************************************************************
+* function: build_filter
+* brief: Compute the area weights for reducing 'src' samples to 'out'
+*
+* Output i covers [i * src, (i + 1) * src) and source sample k covers
+* [k * out, (k + 1) * out), both in units of 1/out source samples, so every
+* overlap is an exact integer. Rounding leftovers go to the largest weight
+* to keep the sum at 256.
+*
+* returns 0 on success, -1 if the ratio needs more than YUV_SCALE_MAX_TAPS
+******************************************************************************/
+static int build_filter(scale_filter *f, int src, int out)
+{
+    if (f->src == src && f->out == out)
+    {
+        return 0;
+    }
+
+    int taps = (src + out - 1) / out + 1;
+    if (taps > src)
+    {
+        taps = src;
+    }
+    if (taps > YUV_SCALE_MAX_TAPS)
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < out; i++)
+    {
+        int lo = i * src;
+        int hi = lo + src;
+        int start = lo / out;
+        int sum = 0;
+        int largest = 0;
+
+        // Keep the taps inside the source; the extra ones get zero weight
+        if (start + taps > src)
+        {
+            start = src - taps;
+        }
+        f->start[i] = start;
+
+        for (int t = 0; t < taps; t++)
+        {
+            int k_lo = (start + t) * out;
+            int k_hi = k_lo + out;
+            int overlap = ((hi < k_hi) ? hi : k_hi) - ((lo > k_lo) ? lo : k_lo);
+            int w = (overlap > 0) ? (overlap * 256 + src / 2) / src : 0;
+
+            f->weight[i][t] = w;
+            sum += w;
+            if (w > f->weight[i][largest])
+            {
+                largest = t;
+            }
+        }
+        f->weight[i][largest] += 256 - sum;
+    }
+
+    f->src = src;
+    f->out = out;
+    f->taps = taps;
+    return 0;
+}
+
+/******************************************************************************
+* function: scale_vertical
+* brief: Blend the source rows under output row 'index' into 'dst'
+******************************************************************************/
+static void scale_vertical(const scale_plane *plane, const scale_filter *f, int index,
+                           yuv_scale_rows_fn scale_rows, uint8_t *dst)
+{
+    const uint8_t *rows[YUV_SCALE_MAX_TAPS];
+
+    for (int t = 0; t < f->taps; t++)
+    {
+        rows[t] = plane->base + (f->start[index] + t) * plane->stride;
+    }
+    scale_rows(rows, f->weight[index], f->taps, dst, plane->span);
+}
+
+/******************************************************************************
+* function: scale_samples
+* brief: Horizontal pass over samples 'step' bytes apart
+******************************************************************************/
+YUV_INLINE void scale_samples(const uint8_t *src, int step, const scale_filter *f, uint8_t *dst)
+{
+    for (int i = 0; i < f->out; i++)
+    {
+        const uint8_t *p = src + f->start[i] * step;
+        unsigned acc = 128;
+
+        for (int t = 0; t < f->taps; t++)
+        {
+            acc += f->weight[i][t] * p[t * step];
+        }
+        dst[i] = acc >> 8;
+    }
+}
+
+/******************************************************************************
+* function: scale_horizontal
+* brief: Horizontal pass, specialized for the sample steps of each layout
+******************************************************************************/
+static void scale_horizontal(const uint8_t *src, int step, const scale_filter *f, uint8_t *dst)
+{
+    switch (step)
+    {
+        case 1:
+            scale_samples(src, 1, f, dst);      // planar
+            break;
+        case 2:
+            scale_samples(src, 2, f, dst);      // NV12/NV21 chroma, YUYV luma
+            break;
+        default:
+            scale_samples(src, 4, f, dst);      // YUYV chroma
+            break;
+    }
+}
+
+/******************************************************************************
+* function: scale_band
+* brief: Scale and convert output rows [row_begin, row_end) (band callback)
+******************************************************************************/
+static void scale_band(void *ctx, int row_begin, int row_end)
+{
+    (void)ctx;
+    uint8_t line[2][2 * YUV_MAX_WIDTH];
+    uint8_t y_rows[2][YUV_SCALE_MAX_OUT];
+    uint8_t u_row[YUV_SCALE_MAX_OUT / 2];
+    uint8_t v_row[YUV_SCALE_MAX_OUT / 2];
+    const yuv_output *out = &scaler.out;
+    yuv_band_histogram hist;
+
+    yuv_histogram_clear(&hist);
+    for (int row = row_begin; row < row_end; row += 2)
+    {
+        uint8_t *dst_row = out->origin + row * out->row_step;
+
+        for (int r = 0; r < 2; r++)
+        {
+            scale_vertical(&scaler.luma, &scaler.luma_v, row + r, scaler.k.scale_rows, line[0]);
+            scale_horizontal(line[0], scaler.luma_step, &scaler.luma_h, y_rows[r]);
+            yuv_histogram_count(&hist, y_rows[r], scaler.out_width);
+        }
+
+        // Grayscale: the chroma rows are never read
+        if (scaler.k.gray)
+        {
+            scaler.k.gray(y_rows[0], dst_row, scaler.out_width, out->col_step);
+            scaler.k.gray(y_rows[1], dst_row + out->row_step, scaler.out_width, out->col_step);
+            continue;
+        }
+
+        for (int p = 0; p < scaler.chroma_planes; p++)
+        {
+            scale_vertical(&scaler.chroma[p], &scaler.chroma_v, row >> 1, scaler.k.scale_rows, line[p]);
+        }
+        scale_horizontal(line[scaler.u.plane] + scaler.u.offset, scaler.u.step, &scaler.chroma_h, u_row);
+        scale_horizontal(line[scaler.v.plane] + scaler.v.offset, scaler.v.step, &scaler.chroma_h, v_row);
+
+        scaler.k.pair(y_rows[0], y_rows[1], u_row, v_row, dst_row, dst_row + out->row_step,
+                      scaler.out_width, out->col_step);
+    }
+    yuv_histogram_merge(&scaler.luma_hist, &hist);
+}
+
+/******************************************************************************
+* function: setup_planes
+* brief: Describe where the crop's luma and chroma samples are in the frame
+******************************************************************************/
+static void setup_planes(const uint8_t *frame, yuv_format_t format, int width, int height,
+                         const yuv_rect *crop)
+{
+    const uint8_t *chroma_plane = frame + width * height;
+    int cx = crop->x / 2;
+    int cy = crop->y / 2;
+
+    switch (format)
+    {
+        case YUV_FORMAT_I420:
+            scaler.luma = (scale_plane){ frame + crop->y * width + crop->x, width, crop->width };
+            scaler.luma_step = 1;
+            scaler.chroma[0] = (scale_plane){ chroma_plane + cy * (width / 2) + cx, width / 2, crop->width / 2 };
+            scaler.chroma[1] = (scale_plane){ chroma_plane + (width * height / 4) + cy * (width / 2) + cx,
+                                              width / 2, crop->width / 2 };
+            scaler.chroma_planes = 2;
+            scaler.u = (scale_sample){ 0, 0, 1 };
+            scaler.v = (scale_sample){ 1, 0, 1 };
+            break;
+
+        case YUV_FORMAT_NV12:
+        case YUV_FORMAT_NV21:
+            scaler.luma = (scale_plane){ frame + crop->y * width + crop->x, width, crop->width };
+            scaler.luma_step = 1;
+            scaler.chroma[0] = (scale_plane){ chroma_plane + cy * width + crop->x, width, crop->width };
+            scaler.chroma_planes = 1;
+            scaler.u = (scale_sample){ 0, (format == YUV_FORMAT_NV21) ? 1 : 0, 2 };
+            scaler.v = (scale_sample){ 0, (format == YUV_FORMAT_NV21) ? 0 : 1, 2 };
+            break;
+
+        default:
+            // YUYV: luma and chroma come from the same packed rows
+            scaler.luma = (scale_plane){ frame + crop->y * width * 2 + crop->x * 2, width * 2, crop->width * 2 };
+            scaler.luma_step = 2;
+            scaler.chroma[0] = scaler.luma;
+            scaler.chroma_planes = 1;
+            scaler.u = (scale_sample){ 0, 1, 4 };
+            scaler.v = (scale_sample){ 0, 3, 4 };
+            break;
+    }
+}
+
+/******************************************************************************
+* function: yuv_frame_scale_to_rgb565
+* brief: Scale a frame or a crop of it to the output size and convert it
+*
+* Parameters:
+*   frame - source frame
+*   format - source layout
+*   src_width, src_height - source size in pixels
+*   crop - source region, NULL for the whole frame
+*   dst - big-endian RGB565 output, in the active orientation
+*   dst_width, dst_height - output size in pixels
+*
+* returns 0 on success, -1 for an unsupported format, crop or size
+******************************************************************************/
+int yuv_frame_scale_to_rgb565(const uint8_t *frame, yuv_format_t format,
+                              int src_width, int src_height, const yuv_rect *crop,
+                              uint8_t *dst, int dst_width, int dst_height)
+{
+    yuv_frame_kernels k;
+    yuv_frame_kernels_get(&k);
+
+    // A transposing orientation fills dst with the picture turned sideways
+    int transposed = yuv_orientation_transposes(k.orientation);
+    int out_width = transposed ? dst_height : dst_width;
+    int out_height = transposed ? dst_width : dst_height;
+
+    yuv_rect area = { 0, 0, src_width, src_height };
+    if (crop)
+    {
+        // Keep the crop on 2x2 chroma block boundaries
+        area.x = crop->x & ~1;
+        area.y = crop->y & ~1;
+        area.width = crop->width & ~1;
+        area.height = crop->height & ~1;
+    }
+
+    if (yuv_frame_size(format, src_width, src_height) == 0 || (src_width & 1) || (src_height & 1) ||
+        area.x < 0 || area.y < 0 || area.width < 2 || area.height < 2 ||
+        area.x + area.width > src_width || area.y + area.height > src_height ||
+        area.width > YUV_MAX_WIDTH ||
+        dst_width < 2 || dst_height < 2 || (dst_width & 1) || (dst_height & 1) ||
+        dst_width > YUV_SCALE_MAX_OUT || dst_height > YUV_SCALE_MAX_OUT ||
+        area.width > out_width * YUV_SCALE_MAX_RATIO || area.height > out_height * YUV_SCALE_MAX_RATIO)
+    {
+        fprintf(stderr, "Unsupported scaling %dx%d+%d+%d of %dx%d %s to %dx%d\n",
+                area.width, area.height, area.x, area.y, src_width, src_height,
+                yuv_format_name(format), dst_width, dst_height);
+        return -1;
+    }
+
+    // YUYV keeps chroma on every row, so its chroma is reduced twice as much
+    int chroma_rows = (format == YUV_FORMAT_YUYV) ? area.height : area.height / 2;
+
+    pthread_mutex_lock(&scaler.lock);
+
+    if (build_filter(&scaler.luma_h, area.width, out_width) != 0 ||
+        build_filter(&scaler.luma_v, area.height, out_height) != 0 ||
+        build_filter(&scaler.chroma_h, area.width / 2, out_width / 2) != 0 ||
+        build_filter(&scaler.chroma_v, chroma_rows, out_height / 2) != 0)
+    {
+        pthread_mutex_unlock(&scaler.lock);
+        fprintf(stderr, "Scaling ratio too large\n");
+        return -1;
+    }
+
+    setup_planes(frame, format, src_width, src_height, &area);
+    scaler.k = k;
+    yuv_output_setup(&scaler.out, dst, out_width, out_height, k.orientation);
+    scaler.out_width = out_width;
+    memset(&scaler.luma_hist, 0, sizeof(scaler.luma_hist));
+
+    convert_pool_run(scale_band, NULL, out_height);
+    yuv_histogram_publish(&scaler.luma_hist);
+
+    pthread_mutex_unlock(&scaler.lock);
+    return 0;
+}
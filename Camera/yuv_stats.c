@@ -0,0 +1,143 @@
+/******************************************************************************
+* YUV_STATS.C
+*
+* Per-frame luma statistics gathered by the conversion pass. The bands count
+* each luma row into a histogram right after the kernel has read it, while
+* the row is still in L1, so the statistics never cost a sweep of their own
+* over the Y plane. When downscaling, the scaled rows are counted instead,
+* so the cost follows the panel size rather than the capture size. Mean,
+* min and max are derived from the 256 bins once the frame is done.
+*
+* Each band counts into four interleaved sub-histograms so a run of equal
+* luma values (flat or dark areas) does not serialize on one counter, and
+* merges them into the frame's histogram once, under a lock, when it ends.
+*
+* Dependencies:
+*   - pthread.h - guards the band merges and the published statistics
+*
+* Author: The One Project is Real
+* Date: 10/16/2026
+* License: Version 2.1, February 1999
+*
+* Copyright (C) 1991, 1999 Free Software Foundation, Inc.
+* <https://fsf.org/>
+* Everyone is permitted to copy and distribute verbatim copies
+* of this license document, but changing it is not allowed.
+*
+* [This is the first released version of the Lesser GPL.  It also counts
+*  as the successor of the GNU Library Public License, version 2, hence
+*  the version number 2.1.]
+*
+******************************************************************************/
+#include "yuv_convert.h"
+#include "yuv_kernels.h"
+#include <string.h>
+#include <pthread.h>
+
+// Statistics of the last finished frame; 'lock' also serializes band merges
+static struct
+{
+    pthread_mutex_t lock;
+    yuv_luma_stats last;
+} stats =
+{
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/******************************************************************************
+* function: yuv_histogram_clear
+* brief: Reset a band histogram before the band's first row
+******************************************************************************/
+void yuv_histogram_clear(yuv_band_histogram *band)
+{
+    memset(band->bins, 0, sizeof(band->bins));
+}
+
+/******************************************************************************
+* function: yuv_histogram_count
+* brief: Count a luma row into a band histogram
+*
+* Parameters:
+*   band - band histogram
+*   y - luma samples
+*   n - number of samples
+******************************************************************************/
+void yuv_histogram_count(yuv_band_histogram *band, const uint8_t *y, int n)
+{
+    int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        band->bins[0][y[i + 0]]++;
+        band->bins[1][y[i + 1]]++;
+        band->bins[2][y[i + 2]]++;
+        band->bins[3][y[i + 3]]++;
+    }
+    for (; i < n; i++)
+    {
+        band->bins[0][y[i]]++;
+    }
+}
+
+/******************************************************************************
+* function: yuv_histogram_merge
+* brief: Add a finished band's counts to its frame's histogram
+******************************************************************************/
+void yuv_histogram_merge(yuv_frame_histogram *frame, const yuv_band_histogram *band)
+{
+    pthread_mutex_lock(&stats.lock);
+    for (int v = 0; v < 256; v++)
+    {
+        frame->bins[v] += band->bins[0][v] + band->bins[1][v] + band->bins[2][v] + band->bins[3][v];
+    }
+    pthread_mutex_unlock(&stats.lock);
+}
+
+/******************************************************************************
+* function: yuv_histogram_publish
+* brief: Derive a finished frame's statistics and make them the current ones
+******************************************************************************/
+void yuv_histogram_publish(const yuv_frame_histogram *frame)
+{
+    yuv_luma_stats s;
+    uint64_t sum = 0;
+
+    memcpy(s.histogram, frame->bins, sizeof(s.histogram));
+    s.pixels = 0;
+    s.min = 255;
+    s.max = 0;
+    for (int v = 0; v < 256; v++)
+    {
+        if (frame->bins[v] == 0)
+        {
+            continue;
+        }
+        if (s.pixels == 0)
+        {
+            s.min = v;
+        }
+        s.max = v;
+        s.pixels += frame->bins[v];
+        sum += (uint64_t)v * frame->bins[v];
+    }
+    s.mean = s.pixels ? (float)sum / s.pixels : 0.0f;
+
+    pthread_mutex_lock(&stats.lock);
+    s.frame = stats.last.frame + 1;
+    stats.last = s;
+    pthread_mutex_unlock(&stats.lock);
+}
+
+/******************************************************************************
+* function: yuv_convert_luma_stats
+* brief: Copy the luma statistics of the last converted frame
+*
+* returns 0 on success, -1 if no frame has been converted yet
+******************************************************************************/
+int yuv_convert_luma_stats(yuv_luma_stats *out)
+{
+    pthread_mutex_lock(&stats.lock);
+    *out = stats.last;
+    pthread_mutex_unlock(&stats.lock);
+    return (out->frame != 0) ? 0 : -1;
+}